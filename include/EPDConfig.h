@@ -14,6 +14,12 @@
 #define EPD_HEIGHT  128
 #define EPD_ROTATION  3
 #define EPD_DRIVER_CLASS  GxEPD2_290
+#define EPD_HAS_FAST_WAVEFORM  0
+#define EPD_HAS_TEMPERATURE_LUT  0
+#define EPD_HAS_WINDOW_CLEAN  0    // Stock GxEPD2_290 cannot load a LUT: cleans flip the window on the partial waveform
+#ifndef EPD_BAND_LINES
+#define EPD_BAND_LINES  0
+#endif
 using EPaperDisplay = GxEPD2_BW<GxEPD2_290, GxEPD2_290::HEIGHT>;
 
 #elif defined(EPD_PANEL_HINK_E042A13_A0)
@@ -22,11 +28,40 @@ using EPaperDisplay = GxEPD2_BW<GxEPD2_290, GxEPD2_290::HEIGHT>;
 #define EPD_HEIGHT  300
 #define EPD_ROTATION  0
 #define EPD_DRIVER_CLASS  GxEPD2_420_HinkE042A13
+#define EPD_HAS_FAST_WAVEFORM  1   // selectFastPartialUpdate(): short black/white LUT for TT_REFRESH_FAST
+#define EPD_HAS_TEMPERATURE_LUT  1 // setTemperature(): waveform timing per temperature band
+#define EPD_HAS_WINDOW_CLEAN  1    // refreshClean(): full-strength LUT over one window (TTLvglEpdDriver::cleanArea)
+#ifndef EPD_BAND_LINES
+#define EPD_BAND_LINES  0          // Off: banding saves RAM but the UI waits on BUSY for every partial frame (README)
+#endif
+#if EPD_BAND_LINES > 0
+// The driver writes bands to the controller itself; GxEPD2_BW's page buffer is left unused
+using EPaperDisplay = GxEPD2_BW<GxEPD2_420_HinkE042A13, 1>;
+#else
 using EPaperDisplay = GxEPD2_BW<GxEPD2_420_HinkE042A13, GxEPD2_420_HinkE042A13::HEIGHT>;
+#endif
 
 #else
 #error "EPDConfig.h: define exactly one of EPD_PANEL_290, EPD_PANEL_HINK_E042A13"
 #endif
 
+/**
+ * Banded rendering: LVGL renders EPD_BAND_LINES-line stripes that TTLvglEpdDriver writes straight into
+ * the controller RAM window, so neither LVGL nor GxEPD2 holds a full frame. 0 renders full frames.
+ * Needs EPD_ROTATION 0 (LVGL rows are controller rows). Set per panel above or with -D EPD_BAND_LINES=N.
+ * Off by default: a partial frame is rendered again after its waveform to rewrite the previous-image RAM,
+ * so the UI task waits on BUSY for every partial refresh even with TT_EPD_PIPELINE.
+ */
+#if EPD_BAND_LINES > 0
+#if EPD_ROTATION != 0 || EPD_WIDTH % 8 != 0
+#error "EPDConfig.h: EPD_BAND_LINES needs EPD_ROTATION 0 and a width in whole bytes"
+#endif
+// One band plus the 8-byte I1 palette
+#define EPD_BUF_SIZE ((EPD_WIDTH / 8 * EPD_BAND_LINES) + 8)
+#else
 #define EPD_BUF_SIZE ((EPD_WIDTH * EPD_HEIGHT / 8) + 8)
+#endif
+#if EPD_HAS_WINDOW_CLEAN && EPD_ROTATION != 0
+#error "EPDConfig.h: EPD_HAS_WINDOW_CLEAN needs EPD_ROTATION 0 (LVGL areas are controller windows)"
+#endif
 #define EPD_FULL_REFRESH_INTERVAL 32
@@ -25,7 +25,12 @@
  *====================*/
 
 /* Size of the memory available for `lv_malloc()` in bytes (>= 2kB) */
+#ifdef TT_NATIVE
+/* Host build: 64-bit pointers roughly double LVGL's object sizes */
+#define LV_MEM_SIZE (64 * 1024U)
+#else
 #define LV_MEM_SIZE (32 * 1024U)
+#endif
 
 /* Use the standard `malloc` and `free` from C library */
 #define LV_STDLIB_INCLUDE <stdlib.h>
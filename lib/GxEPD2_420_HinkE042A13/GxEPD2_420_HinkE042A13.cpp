@@ -2,6 +2,7 @@
 // Partial update uses OPM42 (SSD1619) flow: 0x21 0x00 + partial LUT (0x32) on first use, then 0x20 only.
 
 #include "GxEPD2_420_HinkE042A13.h"
+#include <string.h>
 
 #define LUT_PARTIAL_BYTES 70U
 
@@ -20,11 +21,77 @@ static const uint8_t LUT_PARTIAL_SSD1619[LUT_PARTIAL_BYTES] = {
     0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
+// A2-style fast partial LUT: same voltages as LUT_PARTIAL_SSD1619 (only black<->white transitions are driven),
+// first group cut to 4 frames per phase and run once instead of twice. Leaves some residue; the caller cleans it later.
+static const uint8_t LUT_FAST_SSD1619[LUT_PARTIAL_BYTES] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x82, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x04, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// Windowed clean LUT: partial voltages with the first group at twice the partial phase length, repeated once.
+// refreshClean() is run with the inverse image in the 0x26 RAM, so every pixel of the window is a transition.
+// Only group 0 drives; LUT_PARTIAL_SSD1619's empty second group (zero phase lengths, repeat 1) is left out.
+static const uint8_t LUT_CLEAN_SSD1619[LUT_PARTIAL_BYTES] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x82, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x18, 0x00, 0x18, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// First-group phase length (TP[0A], TP[0B], TP[0D]) of the partial and fast LUTs per temperature band.
+// Ink moves slower in the cold and needs a longer drive to avoid ghosting; warm panels settle with less.
+// Room temperature is split around the tuned 20-25 C band so the usual indoor range gains both ways.
+// Only the 20-25 C row has been checked on a panel; the others are scaled from it (provisional).
+#define LUT_TP0_INDEX 35U
+#define FAST_FULL_MIN_TEMPERATURE 15    // Below this the fast full update (0x1A 0x6E trick) ghosts; use the real OTP LUT
+
+struct TemperatureBand
+{
+  int8_t below;             // Band applies below this temperature (C)
+  uint8_t partial_tp;
+  uint8_t fast_tp;
+  uint16_t partial_time;    // BUSY estimate (ms)
+  uint16_t fast_time;
+};
+
+static const TemperatureBand TEMPERATURE_BANDS[] = {
+  { 5, 0x14, 0x06, 650, 180 },
+  { 15, 0x10, 0x05, 520, 150 },
+  { 20, 0x0e, 0x04, 460, 120 },
+  { 25, 0x0c, 0x04, 400, 120 },     // As tuned in LUT_PARTIAL_SSD1619 / LUT_FAST_SSD1619; also used without a temperature
+  { 28, 0x0a, 0x04, 340, 120 },
+  { 127, 0x08, 0x03, 280, 90 },
+};
+#define TEMPERATURE_BAND_COUNT (sizeof(TEMPERATURE_BANDS) / sizeof(TEMPERATURE_BANDS[0]))
+#define TEMPERATURE_BAND_DEFAULT 3
+
 GxEPD2_420_HinkE042A13::GxEPD2_420_HinkE042A13(int16_t cs, int16_t dc, int16_t rst, int16_t busy) :
   GxEPD2_EPD(cs, dc, rst, busy, HIGH, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate)
 {
   _use_fast_update = useFastFullUpdate;
   _partial_lut_loaded = false;
+  _use_fast_partial = false;
+  _fast_lut_loaded = false;
+  _lut_band = TEMPERATURE_BAND_DEFAULT;
+  _temperature = TEMPERATURE_UNKNOWN;
 }
 
 void GxEPD2_420_HinkE042A13::selectFastFullUpdate(bool ff)
@@ -32,6 +99,26 @@ void GxEPD2_420_HinkE042A13::selectFastFullUpdate(bool ff)
   _use_fast_update = ff;
 }
 
+void GxEPD2_420_HinkE042A13::selectFastPartialUpdate(bool fp)
+{
+  _use_fast_partial = fp;
+}
+
+void GxEPD2_420_HinkE042A13::setTemperature(int8_t celsius)
+{
+  _temperature = celsius;
+}
+
+uint8_t GxEPD2_420_HinkE042A13::_temperatureBand() const
+{
+  if (_temperature == TEMPERATURE_UNKNOWN) return TEMPERATURE_BAND_DEFAULT;
+  for (uint8_t i = 0; i < TEMPERATURE_BAND_COUNT - 1; i++)
+  {
+    if (_temperature < TEMPERATURE_BANDS[i].below) return i;
+  }
+  return TEMPERATURE_BAND_COUNT - 1;
+}
+
 void GxEPD2_420_HinkE042A13::clearScreen(uint8_t value)
 {
   _writeScreenBuffer(0x26, value);
@@ -272,18 +359,32 @@ void GxEPD2_420_HinkE042A13::refresh(bool partial_update_mode)
 void GxEPD2_420_HinkE042A13::refresh(int16_t x, int16_t y, int16_t w, int16_t h)
 {
   if (_initial_refresh) return refresh(false);
+  if (!_setRefreshWindow(x, y, w, h)) return;
+  _Update_Part();
+}
+
+void GxEPD2_420_HinkE042A13::refreshClean(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if (_initial_refresh) return refresh(false);
+  if (!_setRefreshWindow(x, y, w, h)) return;
+  _Update_Clean();
+}
+
+// Clips the window to the panel, widens it to whole bytes and sets the RAM area; false when nothing is left
+bool GxEPD2_420_HinkE042A13::_setRefreshWindow(int16_t x, int16_t y, int16_t w, int16_t h)
+{
   int16_t w1 = x < 0 ? w + x : w;
   int16_t h1 = y < 0 ? h + y : h;
   int16_t x1 = x < 0 ? 0 : x;
   int16_t y1 = y < 0 ? 0 : y;
   w1 = x1 + w1 < int16_t(WIDTH) ? w1 : int16_t(WIDTH) - x1;
   h1 = y1 + h1 < int16_t(HEIGHT) ? h1 : int16_t(HEIGHT) - y1;
-  if ((w1 <= 0) || (h1 <= 0)) return;
+  if ((w1 <= 0) || (h1 <= 0)) return false;
   w1 += x1 % 8;
   if (w1 % 8 > 0) w1 += 8 - w1 % 8;
   x1 -= x1 % 8;
   _setPartialRamArea(x1, y1, w1, h1);
-  _Update_Part();
+  return true;
 }
 
 void GxEPD2_420_HinkE042A13::powerOff()
@@ -300,6 +401,9 @@ void GxEPD2_420_HinkE042A13::hibernate()
     _writeData(0x1);
     _hibernating = true;
     _init_display_done = false;
+    // Waking needs a reset (0x12), which drops the loaded LUT
+    _partial_lut_loaded = false;
+    _fast_lut_loaded = false;
   }
 }
 
@@ -345,7 +449,7 @@ void GxEPD2_420_HinkE042A13::_PowerOff()
   }
   _power_is_on = false;
   _using_partial_mode = false;
-  _partial_lut_loaded = false;
+  // 0x83 only drops analog power and the clock: the LUT register keeps the partial LUT
 }
 
 void GxEPD2_420_HinkE042A13::_InitDisplay()
@@ -371,13 +475,22 @@ void GxEPD2_420_HinkE042A13::_Update_Full()
   _writeCommand(0x21);
   _writeData(0x40);
   _writeData(0x00);
-  if (_use_fast_update)
+  if (_use_fast_update && (_temperature == TEMPERATURE_UNKNOWN || _temperature >= FAST_FULL_MIN_TEMPERATURE))
   {
     _writeCommand(0x1A);
     _writeData(0x6E);
     _writeCommand(0x22);
     _writeData(0xd7);
   }
+  else if (_temperature != TEMPERATURE_UNKNOWN)
+  {
+    // OTP LUT for the given temperature: 0xd7 loads the LUT without reading the internal sensor
+    _writeCommand(0x1A);
+    _writeData((uint8_t)_temperature);
+    _writeData(0x00);
+    _writeCommand(0x22);
+    _writeData(0xd7);
+  }
   else
   {
     _writeCommand(0x22);
@@ -387,21 +500,55 @@ void GxEPD2_420_HinkE042A13::_Update_Full()
   _waitWhileBusy("_Update_Full", full_refresh_time);
   _power_is_on = false;
   _partial_lut_loaded = false;
+  _use_fast_partial = false;
+  _fast_lut_loaded = false;
+}
+
+void GxEPD2_420_HinkE042A13::_Update_Clean()
+{
+  const TemperatureBand& b = TEMPERATURE_BANDS[_temperatureBand()];
+  uint8_t lut[LUT_PARTIAL_BYTES];
+  memcpy(lut, LUT_CLEAN_SSD1619, LUT_PARTIAL_BYTES);
+  uint8_t tp = (uint8_t)(b.partial_tp * 2);
+  lut[LUT_TP0_INDEX] = tp;
+  lut[LUT_TP0_INDEX + 1] = tp;
+  lut[LUT_TP0_INDEX + 3] = tp;
+  _writeCommand(0x21);
+  _writeData(0x00);
+  _writeCommand(0x32);
+  _writeData(lut, LUT_PARTIAL_BYTES);
+  _writeCommand(0x22);
+  _writeData(0xC7);
+  _writeCommand(0x20);
+  _waitWhileBusy("_Update_Clean", (uint16_t)(b.partial_time * 2));
+  _power_is_on = true;
+  // The clean LUT replaced the partial one
+  _partial_lut_loaded = false;
 }
 
 void GxEPD2_420_HinkE042A13::_Update_Part()
 {
-  if (!_partial_lut_loaded)
+  uint8_t band = _temperatureBand();
+  const TemperatureBand& b = TEMPERATURE_BANDS[band];
+  if (!_partial_lut_loaded || _fast_lut_loaded != _use_fast_partial || _lut_band != band)
   {
+    uint8_t lut[LUT_PARTIAL_BYTES];
+    memcpy(lut, _use_fast_partial ? LUT_FAST_SSD1619 : LUT_PARTIAL_SSD1619, LUT_PARTIAL_BYTES);
+    uint8_t tp = _use_fast_partial ? b.fast_tp : b.partial_tp;
+    lut[LUT_TP0_INDEX] = tp;
+    lut[LUT_TP0_INDEX + 1] = tp;
+    lut[LUT_TP0_INDEX + 3] = tp;
     _writeCommand(0x21);
     _writeData(0x00);
     _writeCommand(0x32);
-    _writeData(LUT_PARTIAL_SSD1619, LUT_PARTIAL_BYTES);
+    _writeData(lut, LUT_PARTIAL_BYTES);
     _partial_lut_loaded = true;
+    _fast_lut_loaded = _use_fast_partial;
+    _lut_band = band;
   }
   _writeCommand(0x22);
   _writeData(0xC7);
   _writeCommand(0x20);
-  _waitWhileBusy("_Update_Part", partial_refresh_time);
+  _waitWhileBusy("_Update_Part", _use_fast_partial ? b.fast_time : b.partial_time);
   _power_is_on = true;
 }
@@ -50,9 +50,18 @@ public:
 
     void refresh(bool partial_update_mode = false);
     void refresh(int16_t x, int16_t y, int16_t w, int16_t h);
+    // Full-strength drive of one window (LUT_CLEAN_SSD1619). Write the inverse image with writeImageAgain()
+    // and the image with writeImage() first, so every pixel in the window changes; pixels outside stay put.
+    void refreshClean(int16_t x, int16_t y, int16_t w, int16_t h);
     void powerOff();
     void hibernate();
     void selectFastFullUpdate(bool);
+    // Partial refreshes use LUT_FAST_SSD1619 (short black/white drive) until deselected
+    void selectFastPartialUpdate(bool);
+    // External panel temperature in whole degrees C (SSD1619 0x1A). Picks the partial / fast LUT timing band
+    // and replaces the internal sensor for full refreshes; TEMPERATURE_UNKNOWN returns to the internal sensor.
+    static const int8_t TEMPERATURE_UNKNOWN = -128;
+    void setTemperature(int8_t celsius);
 
 private:
     void _writeScreenBuffer(uint8_t command, uint8_t value);
@@ -60,15 +69,22 @@ private:
     void _writeImagePart(uint8_t command, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                          int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
     void _setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    bool _setRefreshWindow(int16_t x, int16_t y, int16_t w, int16_t h);
     void _PowerOn();
     void _PowerOff();
     void _InitDisplay();
     void _Update_Full();
     void _Update_Part();
+    void _Update_Clean();
+    uint8_t _temperatureBand() const;
 
 private:
     bool _use_fast_update;
     bool _partial_lut_loaded;
+    bool _use_fast_partial;
+    bool _fast_lut_loaded;      // Which LUT _partial_lut_loaded refers to
+    uint8_t _lut_band;          // Temperature band the loaded LUT was built for
+    int8_t _temperature;
 };
 
 #endif
@@ -0,0 +1,33 @@
+#pragma once
+
+// Simulated AHT10/AHT20: reports the values set with TTSim::setSensor()
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Adafruit_Sensor.h"
+
+#define AHTX0_I2CADDR_DEFAULT 0x38
+
+class Adafruit_AHTX0 {
+public:
+    bool begin(TwoWire* wire = &Wire, int32_t sensorId = 0, uint8_t address = AHTX0_I2CADDR_DEFAULT) {
+        (void)wire; (void)sensorId; (void)address;
+        return true;
+    }
+
+    bool getEvent(sensors_event_t* humidity, sensors_event_t* temp) {
+        float t, h, p;
+        TTSim::sensor(t, h, p);
+        if (humidity != nullptr) {
+            memset(humidity, 0, sizeof(*humidity));
+            humidity->relative_humidity = h;
+            humidity->timestamp = (int32_t)millis();
+        }
+        if (temp != nullptr) {
+            memset(temp, 0, sizeof(*temp));
+            temp->temperature = t;
+            temp->timestamp = (int32_t)millis();
+        }
+        return true;
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+// Simulated BMP280: reports the values set with TTSim::setSensor()
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Adafruit_Sensor.h"
+
+#define BMP280_ADDRESS     0x77
+#define BMP280_ADDRESS_ALT 0x76
+
+class Adafruit_BMP280 {
+public:
+    enum sensor_mode { MODE_SLEEP = 0x00, MODE_FORCED = 0x01, MODE_NORMAL = 0x03 };
+    enum sensor_sampling { SAMPLING_NONE, SAMPLING_X1, SAMPLING_X2, SAMPLING_X4, SAMPLING_X8, SAMPLING_X16 };
+    enum sensor_filter { FILTER_OFF, FILTER_X2, FILTER_X4, FILTER_X8, FILTER_X16 };
+    enum standby_duration { STANDBY_MS_1, STANDBY_MS_63, STANDBY_MS_125, STANDBY_MS_250, STANDBY_MS_500,
+                            STANDBY_MS_1000, STANDBY_MS_2000, STANDBY_MS_4000 };
+
+    explicit Adafruit_BMP280(TwoWire* wire = &Wire) { (void)wire; }
+
+    bool begin(uint8_t address = BMP280_ADDRESS, uint8_t chipId = 0x58) { (void)address; (void)chipId; return true; }
+    void setSampling(sensor_mode mode = MODE_NORMAL, sensor_sampling tempSampling = SAMPLING_X16,
+                     sensor_sampling pressSampling = SAMPLING_X16, sensor_filter filter = FILTER_OFF,
+                     standby_duration duration = STANDBY_MS_1) {
+        (void)mode; (void)tempSampling; (void)pressSampling; (void)filter; (void)duration;
+    }
+    bool takeForcedMeasurement() { return true; }
+
+    float readTemperature() { float t, h, p; TTSim::sensor(t, h, p); return t; }
+    /** Pascals, like the real driver. */
+    float readPressure() { float t, h, p; TTSim::sensor(t, h, p); return p * 100.0f; }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+// Host stand-in for Adafruit_GFX: the rotation and pixel interface GxEPD2_BW builds on
+
+#include <Arduino.h>
+
+class Adafruit_GFX {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+    virtual ~Adafruit_GFX() {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t j = y; j < y + h; j++) {
+            for (int16_t i = x; i < x + w; i++) drawPixel(i, j, color);
+        }
+    }
+
+    virtual void setRotation(uint8_t r) {
+        rotation = r & 3;
+        _width = (rotation & 1) ? HEIGHT : WIDTH;
+        _height = (rotation & 1) ? WIDTH : HEIGHT;
+    }
+    uint8_t getRotation() const { return rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    const int16_t WIDTH;
+    const int16_t HEIGHT;
+    int16_t _width;
+    int16_t _height;
+    uint8_t rotation = 0;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+/** The fields of Adafruit's unified sensor event that the firmware reads. */
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t timestamp;
+    union {
+        float temperature;
+        float relative_humidity;
+        float pressure;
+        float data[4];
+    };
+} sensors_event_t;
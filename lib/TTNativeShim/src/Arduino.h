@@ -0,0 +1,152 @@
+#pragma once
+
+// Host stand-in for the ESP32 Arduino core: String, Serial, timing and GPIO (see TTSim.h)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "TTSim.h"
+
+#define ARDUINO 10819
+#define TT_NATIVE_SHIM 1
+
+#define IRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+#define HIGH     0x1
+#define LOW      0x0
+#define INPUT    0x01
+#define OUTPUT   0x03
+#define INPUT_PULLUP    0x05
+#define INPUT_PULLDOWN  0x09
+#define RISING   0x01
+#define FALLING  0x02
+#define CHANGE   0x03
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+#define digitalPinToInterrupt(p) (p)
+
+inline unsigned long millis() { return TTSim::millis(); }
+inline unsigned long micros() { return (unsigned long)TTSim::micros(); }
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+/** Arduino String on std::string; covers the API used by the firmware and ArduinoJson. */
+class String {
+public:
+    String() {}
+    String(const char* s) { if (s != nullptr) _s = s; }
+    String(const std::string& s) : _s(s) {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int v) : _s(std::to_string(v)) {}
+    explicit String(unsigned int v) : _s(std::to_string(v)) {}
+    explicit String(long v) : _s(std::to_string(v)) {}
+    explicit String(unsigned long v) : _s(std::to_string(v)) {}
+    explicit String(float v, unsigned int decimals = 2) { _fromDouble(v, decimals); }
+    explicit String(double v, unsigned int decimals = 2) { _fromDouble(v, decimals); }
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* s) { if (s != nullptr) _s = s; else _s.clear(); return *this; }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+    bool concat(const char* s) { if (s != nullptr) _s += s; return true; }
+    bool concat(const char* s, unsigned int len) { if (s != nullptr) _s.append(s, len); return true; }
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(char c) { _s += c; return true; }
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+
+    int indexOf(char c, unsigned int from = 0) const { size_t p = _s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String& s, unsigned int from = 0) const { size_t p = _s.find(s._s, from); return p == std::string::npos ? -1 : (int)p; }
+    String substring(unsigned int from) const { return from < _s.length() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        return from < _s.length() ? String(_s.substr(from, to - from)) : String();
+    }
+    bool startsWith(const String& s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool endsWith(const String& s) const {
+        return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0;
+    }
+    void trim() {
+        size_t b = _s.find_first_not_of(" \t\r\n");
+        size_t e = _s.find_last_not_of(" \t\r\n");
+        _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+    }
+    long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_s.c_str(), nullptr); }
+
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return o != nullptr && _s == o; }
+    bool operator!=(const String& o) const { return _s != o._s; }
+    bool operator!=(const char* o) const { return !(*this == o); }
+    bool operator<(const String& o) const { return _s < o._s; }
+
+    friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+    friend String operator+(const String& a, const char* b) { String r(a); r.concat(b); return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+
+private:
+    void _fromDouble(double v, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        _s = buf;
+    }
+
+    std::string _s;
+};
+
+/** Referenced by ArduinoJson's Arduino String adapter. */
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+};
+
+/** UART0 on the host: writes go to stdout, reads come from TTSim::serialInput(). */
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    void flush() { fflush(stdout); }
+    size_t write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* buf, size_t len) { return fwrite(buf, 1, len, stdout); }
+    size_t print(const char* s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t println(const char* s = "") { size_t n = print(s); fputc('\n', stdout); return n + 1; }
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,5 @@
+#pragma once
+
+namespace GxEPD2 {
+enum Panel { GDEH029A1, GDEY042T81, TTSimPanel };
+}
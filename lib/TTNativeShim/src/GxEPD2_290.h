@@ -0,0 +1,23 @@
+#pragma once
+
+// Simulated IL3820 2.9" 128x296 (Hink E029A01); refresh times from the GxEPD2_290 driver
+
+#include "GxEPD2_EPD.h"
+
+class GxEPD2_290 : public GxEPD2_EPD {
+public:
+    static const uint16_t WIDTH = 128;
+    static const uint16_t WIDTH_VISIBLE = WIDTH;
+    static const uint16_t HEIGHT = 296;
+    static const GxEPD2::Panel panel = GxEPD2::GDEH029A1;
+    static const bool hasColor = false;
+    static const bool hasPartialUpdate = true;
+    static const bool hasFastPartialUpdate = true;
+    static const uint16_t power_on_time = 100;
+    static const uint16_t power_off_time = 150;
+    static const uint16_t full_refresh_time = 4100;
+    static const uint16_t partial_refresh_time = 500;
+
+    GxEPD2_290(int16_t cs, int16_t dc, int16_t rst, int16_t busy)
+        : GxEPD2_EPD(cs, dc, rst, busy, WIDTH, HEIGHT, full_refresh_time, partial_refresh_time) {}
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+// Simulated Hink E042A13 4.2" 400x300 (SSD1619); stands in for lib/GxEPD2_420_HinkE042A13 on the host
+
+#include "GxEPD2_EPD.h"
+
+class GxEPD2_420_HinkE042A13 : public GxEPD2_EPD {
+public:
+    static const uint16_t WIDTH = 400;
+    static const uint16_t WIDTH_VISIBLE = WIDTH;
+    static const uint16_t HEIGHT = 300;
+    static const GxEPD2::Panel panel = GxEPD2::GDEY042T81;
+    static const bool hasColor = false;
+    static const bool hasPartialUpdate = true;
+    static const bool hasFastPartialUpdate = true;
+    static const uint16_t power_on_time = 100;
+    static const uint16_t power_off_time = 300;
+    static const uint16_t full_refresh_time = 1200;
+    static const uint16_t partial_refresh_time = 400;
+
+    GxEPD2_420_HinkE042A13(int16_t cs, int16_t dc, int16_t rst, int16_t busy)
+        : GxEPD2_EPD(cs, dc, rst, busy, WIDTH, HEIGHT, full_refresh_time, partial_refresh_time) {}
+
+    void selectFastPartialUpdate(bool fp) { fastPartial = fp; }
+    static const int8_t TEMPERATURE_UNKNOWN = -128;
+    /** The simulated panel keeps the default band's timing at any temperature. */
+    void setTemperature(int8_t celsius) { temperature = celsius; }
+    /** Windowed clean: the simulated glass only sees the window's new image. */
+    void refreshClean(int16_t x, int16_t y, int16_t w, int16_t h) { refresh(x, y, w, h); }
+    uint16_t partialTimeMs() const override { return fastPartial ? FAST_BUSY_MS : partial_refresh_time; }
+
+private:
+    static const uint16_t FAST_BUSY_MS = 120;   // Fast LUT BUSY time of the default TEMPERATURE_BANDS entry
+    bool fastPartial = false;
+    int8_t temperature = TEMPERATURE_UNKNOWN;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for GxEPD2_BW: drawing lands in a simulated panel instead of going over SPI
+
+#include "GxEPD2_EPD.h"
+#include "GxEPD2_290.h"
+#include "TTSimDisplay.h"
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_BW : public TTSimDisplay {
+public:
+    GxEPD2_Type epd2;
+
+    GxEPD2_BW(GxEPD2_Type epd2Instance) : TTSimDisplay(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(epd2Instance) {
+        _bindController(&epd2);
+    }
+};
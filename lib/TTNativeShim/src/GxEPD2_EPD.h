@@ -0,0 +1,72 @@
+#pragma once
+
+// Host stand-in for the GxEPD2 controller base: geometry, BUSY callback and nominal timings
+
+#include <Arduino.h>
+#include "GxEPD2.h"
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+
+/** Where controller RAM writes and refreshes land (the simulated panel). */
+class TTSimPanelSink {
+public:
+    virtual ~TTSimPanelSink() {}
+    /** bitmap: rows of (w + 7) / 8 bytes, 1 = white, x byte aligned, physical orientation. */
+    virtual void writeRam(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, int16_t h, bool invert) = 0;
+    virtual void refreshRam(bool full, int16_t x, int16_t y, int16_t w, int16_t h) = 0;
+};
+
+class GxEPD2_EPD {
+public:
+    GxEPD2_EPD(int16_t cs, int16_t dc, int16_t rst, int16_t busy, uint16_t w, uint16_t h,
+               uint16_t fullRefreshMs, uint16_t partialRefreshMs)
+        : WIDTH(w), HEIGHT(h), fullRefreshMs(fullRefreshMs), partialRefreshMs(partialRefreshMs) {
+        (void)cs; (void)dc; (void)rst; (void)busy;
+    }
+
+    void setBusyCallback(void (*busyCallback)(const void*), const void* busyCallbackParameter = 0) {
+        _busyCallback = busyCallback;
+        _busyCallbackParameter = busyCallbackParameter;
+    }
+
+    /** Hold BUSY for ms like _waitWhileBusy(): poll the callback if set, else sleep. */
+    void waitWhileBusy(uint32_t ms) {
+        uint32_t start = millis();
+        while (millis() - start < ms) {
+            if (_busyCallback != nullptr) _busyCallback(_busyCallbackParameter);
+            else delay(1);
+        }
+    }
+
+    // Direct controller RAM access, as used by the banded renderer. The simulated controller keeps one
+    // RAM, so the previous-image writes (ForFullRefresh / Again) land in the same place.
+    void writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false) {
+        if (_sink != nullptr) _sink->writeRam(bitmap, x, y, w, h, invert);
+    }
+    void writeImageForFullRefresh(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false) {
+        writeImage(bitmap, x, y, w, h, invert);
+    }
+    void writeImageAgain(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false) {
+        writeImage(bitmap, x, y, w, h, invert);
+    }
+    void refresh(bool partial_update_mode = false) {
+        if (_sink != nullptr) _sink->refreshRam(!partial_update_mode, 0, 0, (int16_t)WIDTH, (int16_t)HEIGHT);
+    }
+    void refresh(int16_t x, int16_t y, int16_t w, int16_t h) {
+        if (_sink != nullptr) _sink->refreshRam(false, x, y, w, h);
+    }
+    void setSink(TTSimPanelSink* sink) { _sink = sink; }
+    /** BUSY time of the next partial refresh (the waveform currently selected). */
+    virtual uint16_t partialTimeMs() const { return partialRefreshMs; }
+
+    const uint16_t WIDTH;
+    const uint16_t HEIGHT;
+    const uint16_t fullRefreshMs;
+    const uint16_t partialRefreshMs;
+
+private:
+    TTSimPanelSink* _sink = nullptr;
+    void (*_busyCallback)(const void*) = nullptr;
+    const void* _busyCallbackParameter = nullptr;
+};
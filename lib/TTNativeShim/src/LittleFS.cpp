@@ -0,0 +1,217 @@
+#include "LittleFS.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// spiffs (LittleFS) partition size in partitions_8MB.csv
+#define TT_SIM_FS_TOTAL_BYTES 0x3E0000
+
+fs::LittleFSFS LittleFS;
+
+namespace {
+
+std::string g_root = ".pio/native/littlefs";
+std::string g_seed = "data";
+
+bool isDir(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool makeDirs(const std::string& path) {
+    if (path.empty() || isDir(path)) return true;
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos && slash > 0 && !makeDirs(path.substr(0, slash))) return false;
+    return ::mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool copyFile(const std::string& from, const std::string& to) {
+    FILE* in = fopen(from.c_str(), "rb");
+    if (in == nullptr) return false;
+    FILE* out = fopen(to.c_str(), "wb");
+    if (out == nullptr) {
+        fclose(in);
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) fwrite(buf, 1, n, out);
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+bool copyTree(const std::string& from, const std::string& to) {
+    DIR* dir = opendir(from.c_str());
+    if (dir == nullptr) return false;
+    bool ok = makeDirs(to);
+    while (struct dirent* e = readdir(dir)) {
+        std::string name = e->d_name;
+        if (name == "." || name == "..") continue;
+        std::string src = from + "/" + name;
+        ok = (isDir(src) ? copyTree(src, to + "/" + name) : copyFile(src, to + "/" + name)) && ok;
+    }
+    closedir(dir);
+    return ok;
+}
+
+size_t treeBytes(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return 0;
+    size_t total = 0;
+    while (struct dirent* e = readdir(dir)) {
+        std::string name = e->d_name;
+        if (name == "." || name == "..") continue;
+        std::string child = path + "/" + name;
+        struct stat st;
+        if (stat(child.c_str(), &st) != 0) continue;
+        total += S_ISDIR(st.st_mode) ? treeBytes(child) : (size_t)st.st_size;
+    }
+    closedir(dir);
+    return total;
+}
+
+}  // namespace
+
+namespace TTSim {
+
+void setFsRoot(const char* root, const char* seedDir) {
+    g_root = root != nullptr ? root : "";
+    g_seed = seedDir != nullptr ? seedDir : "";
+}
+
+const char* fsRoot() {
+    return g_root.c_str();
+}
+
+}  // namespace TTSim
+
+namespace fs {
+
+File::File(FILE* fp) : _fp(fp, fclose) {}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    return _fp ? fwrite(buf, 1, size, _fp.get()) : 0;
+}
+
+int File::read() {
+    return _fp ? fgetc(_fp.get()) : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return _fp ? fread(buf, 1, size, _fp.get()) : 0;
+}
+
+int File::available() {
+    return _fp ? (int)(size() - position()) : 0;
+}
+
+int File::peek() {
+    if (!_fp) return -1;
+    int c = fgetc(_fp.get());
+    if (c != EOF) ungetc(c, _fp.get());
+    return c;
+}
+
+void File::flush() {
+    if (_fp) fflush(_fp.get());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return _fp && fseek(_fp.get(), (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    return _fp ? (size_t)ftell(_fp.get()) : 0;
+}
+
+size_t File::size() const {
+    if (!_fp) return 0;
+    struct stat st;
+    fflush(_fp.get());
+    return fstat(fileno(_fp.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+String File::readString() {
+    String out;
+    char buf[256];
+    size_t n;
+    while (_fp && (n = fread(buf, 1, sizeof(buf), _fp.get())) > 0) out.concat(buf, (unsigned int)n);
+    return out;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    if (_mounted) return true;
+    if (!isDir(g_root)) {
+        // First mount: behave as if `pio run -t uploadfs` had flashed the seed directory
+        if (!g_seed.empty() && isDir(g_seed)) {
+            if (!copyTree(g_seed, g_root)) return false;
+        } else if (!makeDirs(g_root)) {
+            return false;
+        }
+    }
+    _mounted = true;
+    return true;
+}
+
+bool LittleFSFS::format() {
+    std::string cmd = "rm -rf '" + g_root + "'";
+    if (system(cmd.c_str()) != 0) return false;
+    return makeDirs(g_root);
+}
+
+std::string LittleFSFS::_hostPath(const char* path) const {
+    std::string p = path != nullptr ? path : "";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return g_root + p;
+}
+
+File LittleFSFS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    std::string host = _hostPath(path);
+    bool writing = mode != nullptr && (mode[0] == 'w' || mode[0] == 'a');
+    if (writing) {
+        size_t slash = host.find_last_of('/');
+        if (slash != std::string::npos) makeDirs(host.substr(0, slash));
+    } else if (isDir(host)) {
+        return File();
+    }
+    // Binary stdio modes: "r" -> "rb", "w" -> "wb", "a" -> "ab", "r+" -> "rb+"
+    std::string m = mode != nullptr ? mode : "r";
+    m.insert(1, "b");
+    FILE* fp = fopen(host.c_str(), m.c_str());
+    return fp != nullptr ? File(fp) : File();
+}
+
+bool LittleFSFS::exists(const char* path) {
+    struct stat st;
+    return stat(_hostPath(path).c_str(), &st) == 0;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    return ::remove(_hostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::rename(const char* from, const char* to) {
+    return ::rename(_hostPath(from).c_str(), _hostPath(to).c_str()) == 0;
+}
+
+bool LittleFSFS::mkdir(const char* path) {
+    return makeDirs(_hostPath(path));
+}
+
+size_t LittleFSFS::totalBytes() {
+    return TT_SIM_FS_TOTAL_BYTES;
+}
+
+size_t LittleFSFS::usedBytes() {
+    return treeBytes(g_root);
+}
+
+}  // namespace fs
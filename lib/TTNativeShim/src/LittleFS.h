@@ -0,0 +1,70 @@
+#pragma once
+
+// Host stand-in for the Arduino-ESP32 LittleFS: paths map below TTSim::fsRoot()
+
+#include <Arduino.h>
+#include <memory>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+/** File handle over stdio; copies share the handle like fs::File's FileImplPtr. */
+class File {
+public:
+    File() {}
+    explicit File(FILE* fp);
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size);
+    int read();
+    size_t read(uint8_t* buf, size_t size);
+    int available();
+    int peek();
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    String readString();
+    void close() { _fp.reset(); }
+    operator bool() const { return _fp != nullptr; }
+
+private:
+    std::shared_ptr<FILE> _fp;
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+    size_t totalBytes();
+    size_t usedBytes();
+
+private:
+    std::string _hostPath(const char* path) const;
+    bool _mounted = false;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+extern fs::LittleFSFS LittleFS;
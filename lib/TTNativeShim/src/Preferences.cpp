@@ -0,0 +1,88 @@
+#include "Preferences.h"
+#include <mutex>
+
+namespace {
+
+// NVS keys are limited to 15 characters
+const size_t NVS_KEY_NAME_MAX = 15;
+
+std::mutex& nvsMutex() {
+    static std::mutex m;
+    return m;
+}
+
+std::map<std::string, std::map<std::string, std::vector<uint8_t>>>& nvsStore() {
+    static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> store;
+    return store;
+}
+
+}  // namespace
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (name == nullptr || strlen(name) > NVS_KEY_NAME_MAX) return false;
+    std::lock_guard<std::mutex> lock(nvsMutex());
+    _ns = &nvsStore()[name];
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    _ns = nullptr;
+}
+
+bool Preferences::clear() {
+    if (_ns == nullptr || _readOnly) return false;
+    std::lock_guard<std::mutex> lock(nvsMutex());
+    _ns->clear();
+    return true;
+}
+
+bool Preferences::isKey(const char* key) {
+    return _find(key) != nullptr;
+}
+
+bool Preferences::remove(const char* key) {
+    if (_ns == nullptr || _readOnly || key == nullptr) return false;
+    std::lock_guard<std::mutex> lock(nvsMutex());
+    return _ns->erase(key) > 0;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (value == nullptr) return 0;
+    // Stored with its terminator like NVS; the return value excludes it
+    return _put(key, value, strlen(value) + 1) > 0 ? strlen(value) : 0;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    Value* v = _find(key);
+    if (v == nullptr || v->empty()) return defaultValue;
+    return String((const char*)v->data());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    Value* v = _find(key);
+    return v != nullptr ? v->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    Value* v = _find(key);
+    if (v == nullptr || buf == nullptr || v->size() > maxLen) return 0;
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+}
+
+size_t Preferences::_put(const char* key, const void* value, size_t len) {
+    if (_ns == nullptr || _readOnly || key == nullptr || strlen(key) > NVS_KEY_NAME_MAX) return 0;
+    std::lock_guard<std::mutex> lock(nvsMutex());
+    const uint8_t* p = (const uint8_t*)value;
+    (*_ns)[key].assign(p, p + len);
+    return len;
+}
+
+Preferences::Value* Preferences::_find(const char* key) {
+    if (_ns == nullptr || key == nullptr) return nullptr;
+    std::lock_guard<std::mutex> lock(nvsMutex());
+    auto it = _ns->find(key);
+    return it != _ns->end() ? &it->second : nullptr;
+}
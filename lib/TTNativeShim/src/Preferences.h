@@ -0,0 +1,48 @@
+#pragma once
+
+// Host stand-in for the Arduino-ESP32 Preferences (NVS). Values live in memory for the run.
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+    bool clear();
+    bool isKey(const char* key);
+    bool remove(const char* key);
+
+    size_t putInt(const char* key, int32_t value) { return _put(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return _put(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return _put(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { uint8_t v = value ? 1 : 0; return _put(key, &v, 1); }
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return _put(key, value, len); }
+
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return _get(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return _get(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return _get(key, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return _get(key, (uint8_t)(defaultValue ? 1 : 0)) != 0; }
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    typedef std::vector<uint8_t> Value;
+
+    size_t _put(const char* key, const void* value, size_t len);
+    Value* _find(const char* key);
+    template <typename T> T _get(const char* key, T defaultValue) {
+        Value* v = _find(key);
+        if (v == nullptr || v->size() != sizeof(T)) return defaultValue;
+        T out;
+        memcpy(&out, v->data(), sizeof(T));
+        return out;
+    }
+
+    std::map<std::string, Value>* _ns = nullptr;
+    bool _readOnly = false;
+};
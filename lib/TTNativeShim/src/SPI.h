@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for the Arduino SPI bus; the simulated panel never clocks bytes out
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) { (void)sck; (void)miso; (void)mosi; (void)ss; }
+    void end() {}
+    void beginTransaction(const SPISettings& settings) { (void)settings; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { (void)data; return 0; }
+    void transfer(void* buf, size_t count) { (void)buf; (void)count; }
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,142 @@
+#include "TTSim.h"
+#include "Arduino.h"
+#include "TTSimScheduler.h"
+#include <SPI.h>
+#include <Wire.h>
+#include <stdarg.h>
+#include <deque>
+#include <mutex>
+
+HardwareSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+
+namespace {
+
+struct PinState {
+    int level = LOW;
+    void (*handler)(void*) = nullptr;
+    void* arg = nullptr;
+    int mode = 0;
+};
+
+std::mutex& ioMutex() {
+    static std::mutex m;
+    return m;
+}
+
+PinState g_pins[64];
+std::deque<uint8_t> g_serialIn;
+
+float g_temperature = 22.5f;
+float g_humidity = 45.0f;
+float g_pressure = 1013.2f;
+
+}  // namespace
+
+namespace TTSim {
+
+void setPin(uint8_t pin, int level) {
+    if (pin >= 64) return;
+    void (*handler)(void*) = nullptr;
+    void* arg = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(ioMutex());
+        PinState& p = g_pins[pin];
+        level = level ? HIGH : LOW;
+        if (p.level == level) return;
+        p.level = level;
+        bool fire = p.mode == CHANGE || (p.mode == RISING && level == HIGH) || (p.mode == FALLING && level == LOW);
+        if (fire) {
+            handler = p.handler;
+            arg = p.arg;
+        }
+    }
+    if (handler != nullptr) handler(arg);
+}
+
+int pin(uint8_t pin) {
+    if (pin >= 64) return LOW;
+    std::lock_guard<std::mutex> lock(ioMutex());
+    return g_pins[pin].level;
+}
+
+void serialInput(const char* text) {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    for (const char* p = text; *p != '\0'; p++) g_serialIn.push_back((uint8_t)*p);
+}
+
+void setSensor(float temperatureC, float humidityPct, float pressureHpa) {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    g_temperature = temperatureC;
+    g_humidity = humidityPct;
+    g_pressure = pressureHpa;
+}
+
+void sensor(float& temperatureC, float& humidityPct, float& pressureHpa) {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    temperatureC = g_temperature;
+    humidityPct = g_humidity;
+    pressureHpa = g_pressure;
+}
+
+}  // namespace TTSim
+
+void delay(uint32_t ms) {
+    TTSimScheduler::instance().sleep(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+    TTSimScheduler::instance().sleep((us + 999) / 1000);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return TTSim::pin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    TTSim::setPin(pin, level);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= 64) return;
+    std::lock_guard<std::mutex> lock(ioMutex());
+    g_pins[pin].handler = handler;
+    g_pins[pin].arg = arg;
+    g_pins[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    attachInterruptArg(pin, nullptr, nullptr, 0);
+}
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    return (int)g_serialIn.size();
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    if (g_serialIn.empty()) return -1;
+    int c = g_serialIn.front();
+    g_serialIn.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> lock(ioMutex());
+    return g_serialIn.empty() ? -1 : g_serialIn.front();
+}
+
+size_t HardwareSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
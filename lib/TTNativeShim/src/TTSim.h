@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Control surface of the native (host) build. The shims in this library stand in for the ESP32
+ * Arduino core so the firmware's tasks, LVGL driver, fonts and pages run unchanged on Linux.
+ *
+ * Time: by default millis() / micros() follow the host clock. With useVirtualClock(true) (call
+ * before any task starts) time only moves in advance(): every TTVTask runs until it blocks in
+ * ulTaskNotifyTake / vTaskDelay / a queue, then the clock jumps to the next deadline. Runs are
+ * repeatable, and long waits (sensor intervals, waveform BUSY) cost no wall time.
+ */
+namespace TTSim {
+
+void useVirtualClock(bool enable);
+bool isVirtualClock();
+
+uint32_t millis();
+uint64_t micros();
+
+/** Let the tasks run for ms of (virtual or real) time. Call from the host thread, not from a task. */
+void advance(uint32_t ms);
+
+/** Virtual clock: block until every task is waiting on a future deadline or a notification. */
+void waitIdle();
+
+/** Drive a GPIO input; registered CHANGE / RISING / FALLING interrupts run on the caller like an ISR. */
+void setPin(uint8_t pin, int level);
+int pin(uint8_t pin);
+
+/** Queue bytes for Serial.read() (the TTLogTask console). */
+void serialInput(const char* text);
+
+/**
+ * LittleFS root on the host. On first begin() the seed directory (the project's data/, what
+ * `pio run -t uploadfs` would flash) is copied into root.
+ */
+void setFsRoot(const char* root, const char* seedDir);
+const char* fsRoot();
+
+/** Values returned by the simulated AHT20 / BMP280. */
+void setSensor(float temperatureC, float humidityPct, float pressureHpa);
+void sensor(float& temperatureC, float& humidityPct, float& pressureHpa);
+
+/** One panel update as the controller would run it; the rect is physical and byte-aligned in x. */
+struct Refresh {
+    uint32_t index;
+    uint32_t timeMs;
+    bool full;              // Full waveform (setFullWindow, or the first update after init)
+    int16_t x, y;
+    uint16_t w, h;
+    uint32_t flipped;       // Pixels inside the rect whose colour changed
+};
+
+/**
+ * Simulated panel (GxEPD2_BW). Each refresh is recorded; with a frame directory set, the panel
+ * content after it is written as frame_NNNNN.pbm (logical orientation) and appended to
+ * refreshes.csv. With waveform timing on, a refresh holds BUSY for the driver's nominal
+ * full / partial refresh time and runs the GxEPD2 busy callback meanwhile.
+ */
+void setFrameDir(const char* dir);
+void setWaveformTiming(bool enable);
+uint32_t refreshCount();
+bool refreshAt(uint32_t index, Refresh& out);
+void clearRefreshes();
+/** Current panel content as PBM; false when no display exists yet or the file cannot be written. */
+bool writePanelPbm(const char* path);
+
+}  // namespace TTSim
@@ -0,0 +1,300 @@
+#include "TTSimDisplay.h"
+#include <sys/stat.h>
+
+TTSimDisplay* TTSimDisplay::_active = nullptr;
+
+namespace {
+
+// Settings made before the display exists (TTUITask owns it) apply when it is constructed
+std::string g_frameDir;
+bool g_waveformTiming = false;
+
+}  // namespace
+
+TTSimDisplay::TTSimDisplay(int16_t w, int16_t h)
+    : Adafruit_GFX(w, h), _ram((size_t)w * h, 1), _panel((size_t)w * h, 1) {
+    _active = this;
+    setFullWindow();
+    setFrameDir(g_frameDir.c_str());
+    _waveformTiming = g_waveformTiming;
+}
+
+TTSimDisplay::~TTSimDisplay() {
+    if (_active == this) _active = nullptr;
+}
+
+void TTSimDisplay::init(uint32_t serialDiagBitrate) {
+    init(serialDiagBitrate, true);
+}
+
+void TTSimDisplay::init(uint32_t serialDiagBitrate, bool initial, uint16_t resetDuration, bool pulldownRstMode) {
+    (void)serialDiagBitrate;
+    (void)resetDuration;
+    (void)pulldownRstMode;
+    _initialRefresh = initial;
+    setFullWindow();
+}
+
+void TTSimDisplay::init(uint32_t serialDiagBitrate, bool initial, uint16_t resetDuration, bool pulldownRstMode,
+                        SPIClass& spi, SPISettings settings) {
+    (void)spi;
+    (void)settings;
+    init(serialDiagBitrate, initial, resetDuration, pulldownRstMode);
+}
+
+void TTSimDisplay::_rotate(int16_t& x, int16_t& y, int16_t& w, int16_t& h) const {
+    // Same as GxEPD2_BW::_rotate
+    switch (rotation) {
+        case 1:
+            std::swap(x, y);
+            std::swap(w, h);
+            x = WIDTH - x - w;
+            break;
+        case 2:
+            x = WIDTH - x - w;
+            y = HEIGHT - y - h;
+            break;
+        case 3:
+            std::swap(x, y);
+            std::swap(w, h);
+            y = HEIGHT - y - h;
+            break;
+    }
+}
+
+bool TTSimDisplay::_toPhysical(int16_t& x, int16_t& y) const {
+    if (x < 0 || x >= width() || y < 0 || y >= height()) return false;
+    switch (rotation) {
+        case 1:
+            std::swap(x, y);
+            x = WIDTH - x - 1;
+            break;
+        case 2:
+            x = WIDTH - x - 1;
+            y = HEIGHT - y - 1;
+            break;
+        case 3:
+            std::swap(x, y);
+            y = HEIGHT - y - 1;
+            break;
+    }
+    return true;
+}
+
+void TTSimDisplay::setFullWindow() {
+    _partialWindow = false;
+    _wx = 0;
+    _wy = 0;
+    _ww = WIDTH;
+    _wh = HEIGHT;
+}
+
+void TTSimDisplay::setPartialWindow(int16_t x, int16_t y, int16_t w, int16_t h) {
+    _rotate(x, y, w, h);
+    // The controller addresses x in bytes: widen the window to whole bytes, then clip
+    int16_t x1 = std::max<int16_t>(0, x) & ~7;
+    int16_t x2 = std::min<int16_t>(WIDTH, (int16_t)((x + w + 7) & ~7));
+    int16_t y1 = std::max<int16_t>(0, y);
+    int16_t y2 = std::min<int16_t>(HEIGHT, (int16_t)(y + h));
+    _partialWindow = true;
+    _wx = x1;
+    _wy = y1;
+    _ww = x2 > x1 ? x2 - x1 : 0;
+    _wh = y2 > y1 ? y2 - y1 : 0;
+}
+
+void TTSimDisplay::firstPage() {
+    // GxEPD2_BW clears the page buffer, so unpainted window pixels (byte padding) go white
+    fillScreen(GxEPD_WHITE);
+}
+
+bool TTSimDisplay::nextPage() {
+    _refresh(!_partialWindow, _wx, _wy, _ww, _wh);
+    return false;
+}
+
+void TTSimDisplay::display(bool partialUpdateMode) {
+    _refresh(!(partialUpdateMode && _partialWindow), _wx, _wy, _ww, _wh);
+}
+
+void TTSimDisplay::writeRam(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, int16_t h, bool invert) {
+    // Same clipping as the controller: x in whole bytes, window cut at the panel edge
+    int16_t wb = (w + 7) / 8;
+    x -= x % 8;
+    for (int16_t j = 0; j < h; j++) {
+        int16_t py = y + j;
+        if (py < 0 || py >= HEIGHT) continue;
+        for (int16_t i = 0; i < wb * 8; i++) {
+            int16_t px = x + i;
+            if (px < 0 || px >= WIDTH) continue;
+            uint8_t bit = (bitmap[(size_t)j * wb + i / 8] >> (7 - i % 8)) & 0x01;
+            _ram[(size_t)py * WIDTH + px] = invert ? bit ^ 1 : bit;
+        }
+    }
+}
+
+void TTSimDisplay::refreshRam(bool full, int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t x1 = std::max<int16_t>(0, x) & ~7;
+    int16_t x2 = std::min<int16_t>(WIDTH, (int16_t)((x + w + 7) & ~7));
+    int16_t y1 = std::max<int16_t>(0, y);
+    int16_t y2 = std::min<int16_t>(HEIGHT, (int16_t)(y + h));
+    if (x2 <= x1 || y2 <= y1) return;
+    _refresh(full, x1, y1, x2 - x1, y2 - y1);
+}
+
+void TTSimDisplay::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!_toPhysical(x, y)) return;
+    if (x < _wx || x >= _wx + _ww || y < _wy || y >= _wy + _wh) return;
+    _ram[(size_t)y * WIDTH + x] = color == GxEPD_BLACK ? 0 : 1;
+}
+
+void TTSimDisplay::fillScreen(uint16_t color) {
+    uint8_t v = color == GxEPD_BLACK ? 0 : 1;
+    for (int16_t y = _wy; y < _wy + _wh; y++) {
+        std::fill(_ram.begin() + (size_t)y * WIDTH + _wx, _ram.begin() + (size_t)y * WIDTH + _wx + _ww, v);
+    }
+}
+
+void TTSimDisplay::_refresh(bool full, int16_t x, int16_t y, int16_t w, int16_t h) {
+    // After init(initial = true) the first update is always full, as in GxEPD2
+    if (_initialRefresh) full = true;
+    _initialRefresh = false;
+
+    if (full) {
+        x = 0;
+        y = 0;
+        w = WIDTH;
+        h = HEIGHT;
+    }
+
+    uint32_t flipped = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (int16_t j = y; j < y + h; j++) {
+            for (int16_t i = x; i < x + w; i++) {
+                size_t idx = (size_t)j * WIDTH + i;
+                if (_panel[idx] != _ram[idx]) flipped++;
+                _panel[idx] = _ram[idx];
+            }
+        }
+    }
+
+    if (_waveformTiming && _epd != nullptr) {
+        _epd->waitWhileBusy(full ? _epd->fullRefreshMs : _epd->partialTimeMs());
+    }
+
+    TTSim::Refresh r;
+    r.timeMs = millis();
+    r.full = full;
+    r.x = x;
+    r.y = y;
+    r.w = (uint16_t)w;
+    r.h = (uint16_t)h;
+    r.flipped = flipped;
+
+    std::string frameDir;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        r.index = _frameIndex++;
+        _refreshes.push_back(r);
+        frameDir = _frameDir;
+    }
+    if (frameDir.empty()) return;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u.pbm", frameDir.c_str(), (unsigned)r.index);
+    writePbm(path);
+    snprintf(path, sizeof(path), "%s/refreshes.csv", frameDir.c_str());
+    if (FILE* csv = fopen(path, "a")) {
+        fprintf(csv, "%u,%u,%s,%d,%d,%u,%u,%u\n", (unsigned)r.index, (unsigned)r.timeMs, r.full ? "full" : "partial",
+                r.x, r.y, r.w, r.h, (unsigned)r.flipped);
+        fclose(csv);
+    }
+}
+
+bool TTSimDisplay::writePbm(const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == nullptr) return false;
+
+    // P4: 1 = black, rows padded to whole bytes; logical orientation, as the user sees the panel
+    int16_t w = width();
+    int16_t h = height();
+    fprintf(fp, "P4\n%d %d\n", w, h);
+    std::vector<uint8_t> row((size_t)(w + 7) / 8);
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int16_t ly = 0; ly < h; ly++) {
+        std::fill(row.begin(), row.end(), 0);
+        for (int16_t lx = 0; lx < w; lx++) {
+            int16_t px = lx, py = ly;
+            _toPhysical(px, py);
+            if (_panel[(size_t)py * WIDTH + px] == 0) row[lx / 8] |= (uint8_t)(0x80 >> (lx % 8));
+        }
+        fwrite(row.data(), 1, row.size(), fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+void TTSimDisplay::setFrameDir(const char* dir) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _frameDir = dir != nullptr ? dir : "";
+    if (_frameDir.empty()) return;
+    mkdir(_frameDir.c_str(), 0755);
+    std::string csv = _frameDir + "/refreshes.csv";
+    if (FILE* fp = fopen(csv.c_str(), "w")) {
+        fputs("index,time_ms,type,x,y,w,h,flipped\n", fp);
+        fclose(fp);
+    }
+}
+
+uint32_t TTSimDisplay::refreshCount() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (uint32_t)_refreshes.size();
+}
+
+bool TTSimDisplay::refreshAt(uint32_t index, TTSim::Refresh& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (index >= _refreshes.size()) return false;
+    out = _refreshes[index];
+    return true;
+}
+
+void TTSimDisplay::clearRefreshes() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _refreshes.clear();
+}
+
+// ---- TTSim panel controls ----
+
+namespace TTSim {
+
+void setFrameDir(const char* dir) {
+    g_frameDir = dir != nullptr ? dir : "";
+    if (TTSimDisplay* d = TTSimDisplay::active()) d->setFrameDir(dir);
+}
+
+void setWaveformTiming(bool enable) {
+    g_waveformTiming = enable;
+    if (TTSimDisplay* d = TTSimDisplay::active()) d->setWaveformTiming(enable);
+}
+
+uint32_t refreshCount() {
+    TTSimDisplay* d = TTSimDisplay::active();
+    return d != nullptr ? d->refreshCount() : 0;
+}
+
+bool refreshAt(uint32_t index, Refresh& out) {
+    TTSimDisplay* d = TTSimDisplay::active();
+    return d != nullptr && d->refreshAt(index, out);
+}
+
+void clearRefreshes() {
+    if (TTSimDisplay* d = TTSimDisplay::active()) d->clearRefreshes();
+}
+
+bool writePanelPbm(const char* path) {
+    TTSimDisplay* d = TTSimDisplay::active();
+    return d != nullptr && d->writePbm(path);
+}
+
+}  // namespace TTSim
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <SPI.h>
+#include <mutex>
+#include <vector>
+#include "GxEPD2_EPD.h"
+#include "TTSim.h"
+
+/**
+ * Panel model behind the GxEPD2_BW shim. _ram is the controller RAM the next refresh shows,
+ * _panel what the glass shows now; both physical, one byte per pixel (1 = white).
+ */
+class TTSimDisplay : public Adafruit_GFX, public TTSimPanelSink {
+public:
+    TTSimDisplay(int16_t w, int16_t h);
+    ~TTSimDisplay();
+
+    void init(uint32_t serialDiagBitrate = 0);
+    void init(uint32_t serialDiagBitrate, bool initial, uint16_t resetDuration = 10, bool pulldownRstMode = false);
+    void init(uint32_t serialDiagBitrate, bool initial, uint16_t resetDuration, bool pulldownRstMode,
+              SPIClass& spi, SPISettings settings);
+
+    void setFullWindow();
+    void setPartialWindow(int16_t x, int16_t y, int16_t w, int16_t h);
+    void firstPage();
+    bool nextPage();
+    /** The shim always buffers the whole window, like GxEPD2_BW with page_height == HEIGHT. */
+    uint16_t pages() const { return 1; }
+    /** Write _ram and refresh it: partial over the current window, else full. */
+    void display(bool partialUpdateMode = false);
+    void hibernate() {}
+    void powerOff() {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    bool writePbm(const char* path);
+    void setFrameDir(const char* dir);
+    void setWaveformTiming(bool enable) { _waveformTiming = enable; }
+    uint32_t refreshCount();
+    bool refreshAt(uint32_t index, TTSim::Refresh& out);
+    void clearRefreshes();
+
+    static TTSimDisplay* active() { return _active; }
+
+    // TTSimPanelSink: epd2 writes straight into _ram
+    void writeRam(const uint8_t* bitmap, int16_t x, int16_t y, int16_t w, int16_t h, bool invert) override;
+    void refreshRam(bool full, int16_t x, int16_t y, int16_t w, int16_t h) override;
+
+protected:
+    void _bindController(GxEPD2_EPD* epd) {
+        _epd = epd;
+        epd->setSink(this);
+    }
+
+private:
+    void _rotate(int16_t& x, int16_t& y, int16_t& w, int16_t& h) const;
+    bool _toPhysical(int16_t& x, int16_t& y) const;
+    void _refresh(bool full, int16_t x, int16_t y, int16_t w, int16_t h);
+
+    GxEPD2_EPD* _epd = nullptr;
+    std::vector<uint8_t> _ram;
+    std::vector<uint8_t> _panel;
+    bool _partialWindow = false;
+    bool _initialRefresh = true;
+    bool _waveformTiming = false;
+    int16_t _wx = 0, _wy = 0, _ww = 0, _wh = 0;     // Physical window, x / w multiples of 8
+
+    std::mutex _mutex;                              // Guards _panel, the records and the frame dir
+    std::vector<TTSim::Refresh> _refreshes;
+    std::string _frameDir;
+    uint32_t _frameIndex = 0;
+
+    static TTSimDisplay* _active;
+};
@@ -0,0 +1,287 @@
+#include "TTSimScheduler.h"
+#include "TTSim.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+namespace {
+
+thread_local TTSimTask* t_current = nullptr;
+
+std::recursive_mutex& criticalMutex() {
+    static std::recursive_mutex m;
+    return m;
+}
+
+uint64_t hostUs() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+TTSimScheduler& TTSimScheduler::instance() {
+    static TTSimScheduler scheduler;
+    return scheduler;
+}
+
+uint64_t TTSimScheduler::nowUs() {
+    return _virtual ? _virtualUs.load() : hostUs();
+}
+
+TTSimTask* TTSimScheduler::create(const char* name, BaseType_t coreId) {
+    TTSimTask* task = new TTSimTask();
+    task->name = name != nullptr ? name : "";
+    task->coreId = coreId;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(task);
+    return task;
+}
+
+void TTSimScheduler::remove(TTSimTask* task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.erase(std::remove(_tasks.begin(), _tasks.end(), task), _tasks.end());
+    _cv.notify_all();
+}
+
+TTSimTask* TTSimScheduler::current() {
+    return t_current;
+}
+
+void TTSimScheduler::setCurrent(TTSimTask* task) {
+    t_current = task;
+}
+
+bool TTSimScheduler::block(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, uint32_t timeoutMs) {
+    if (ready()) return true;
+    if (timeoutMs == 0) return false;
+
+    TTSimTask* task = t_current;
+    if (!_virtual || task == nullptr) {
+        // Real clock, or the host thread (never counted by the virtual clock)
+        if (timeoutMs == portMAX_DELAY) {
+            _cv.wait(lock, ready);
+            return true;
+        }
+        return _cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    }
+
+    uint64_t deadline = timeoutMs == portMAX_DELAY ? UINT64_MAX : _virtualUs.load() + (uint64_t)timeoutMs * 1000;
+    task->blocked = true;
+    task->deadlineUs = deadline;
+    task->ready = ready;
+    _cv.notify_all();
+    _cv.wait(lock, [&]() { return ready() || _virtualUs.load() >= deadline; });
+    task->blocked = false;
+    task->deadlineUs = UINT64_MAX;
+    task->ready = nullptr;
+    _cv.notify_all();
+    return ready();
+}
+
+bool TTSimScheduler::_quiescent() const {
+    uint64_t now = _virtualUs.load();
+    for (const TTSimTask* task : _tasks) {
+        if (!task->blocked || task->deadlineUs <= now || (task->ready && task->ready())) return false;
+    }
+    return true;
+}
+
+void TTSimScheduler::_waitQuiescent(std::unique_lock<std::mutex>& lock) {
+    _cv.wait(lock, [this]() { return _quiescent(); });
+}
+
+void TTSimScheduler::sleep(uint32_t ms) {
+    if (t_current != nullptr) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        block(lock, []() { return false; }, ms == 0 ? 1 : ms);
+    } else {
+        advance(ms);
+    }
+}
+
+void TTSimScheduler::advance(uint32_t ms) {
+    if (!_virtual) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    uint64_t target = _virtualUs.load() + (uint64_t)ms * 1000;
+    while (true) {
+        _waitQuiescent(lock);
+        uint64_t next = UINT64_MAX;
+        for (const TTSimTask* task : _tasks) next = std::min(next, task->deadlineUs);
+        if (next > target) break;
+        _virtualUs = next;
+        _cv.notify_all();
+    }
+    _virtualUs = target;
+    _cv.notify_all();
+    _waitQuiescent(lock);
+}
+
+void TTSimScheduler::waitIdle() {
+    if (!_virtual) return;
+    std::unique_lock<std::mutex> lock(_mutex);
+    _waitQuiescent(lock);
+}
+
+// ---- TTSim clock ----
+
+namespace TTSim {
+
+void useVirtualClock(bool enable) {
+    TTSimScheduler::instance().setVirtual(enable);
+}
+
+bool isVirtualClock() {
+    return TTSimScheduler::instance().isVirtual();
+}
+
+uint32_t millis() {
+    return (uint32_t)(TTSimScheduler::instance().nowUs() / 1000);
+}
+
+uint64_t micros() {
+    return TTSimScheduler::instance().nowUs();
+}
+
+void advance(uint32_t ms) {
+    TTSimScheduler::instance().advance(ms);
+}
+
+void waitIdle() {
+    TTSimScheduler::instance().waitIdle();
+}
+
+}  // namespace TTSim
+
+// ---- FreeRTOS: port ----
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    // One recursive lock for every mux: critical sections nest and never block inside
+    criticalMutex().lock();
+    mux->locked++;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    mux->locked--;
+    criticalMutex().unlock();
+}
+
+BaseType_t xPortGetCoreID() {
+    // The Arduino loop (host thread) runs on core 1
+    return t_current != nullptr ? t_current->coreId : 1;
+}
+
+// ---- FreeRTOS: tasks ----
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId) {
+    (void)stackDepth;
+    (void)priority;
+    TTSimTask* task = TTSimScheduler::instance().create(name, coreId);
+    if (created != nullptr) *created = task;
+    std::thread([fn, param, task]() {
+        TTSimScheduler::setCurrent(task);
+        fn(param);
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    TTSimScheduler& s = TTSimScheduler::instance();
+    TTSimTask* target = task != nullptr ? task : t_current;
+    if (target == nullptr) return;
+    s.remove(target);
+    if (target == t_current) {
+        // A deleted task never returns; park the thread outside the virtual clock's bookkeeping
+        std::unique_lock<std::mutex> lock(s.mutex());
+        s.block(lock, []() { return false; }, portMAX_DELAY);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    TTSimScheduler::instance().sleep(ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+    return TTSim::millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return t_current;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    TTSimScheduler& s = TTSimScheduler::instance();
+    std::lock_guard<std::mutex> lock(s.mutex());
+    task->notifyCount++;
+    s.changed();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken != nullptr) *higherPriorityTaskWoken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    TTSimScheduler& s = TTSimScheduler::instance();
+    TTSimTask* task = t_current;
+    if (task == nullptr) return 0;
+    std::unique_lock<std::mutex> lock(s.mutex());
+    if (!s.block(lock, [task]() { return task->notifyCount > 0; }, ticksToWait)) return 0;
+    uint32_t value = task->notifyCount;
+    task->notifyCount = clearCountOnExit ? 0 : value - 1;
+    return value;
+}
+
+// ---- FreeRTOS: queues ----
+
+struct TTSimQueue {
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    TTSimQueue* queue = new TTSimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    TTSimScheduler& s = TTSimScheduler::instance();
+    std::unique_lock<std::mutex> lock(s.mutex());
+    if (!s.block(lock, [queue]() { return queue->items.size() < queue->length; }, ticksToWait)) return errQUEUE_FULL;
+    const uint8_t* p = (const uint8_t*)item;
+    queue->items.emplace_back(p, p + queue->itemSize);
+    s.changed();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    TTSimScheduler& s = TTSimScheduler::instance();
+    std::unique_lock<std::mutex> lock(s.mutex());
+    if (!s.block(lock, [queue]() { return !queue->items.empty(); }, ticksToWait)) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    s.changed();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(TTSimScheduler::instance().mutex());
+    return (UBaseType_t)queue->items.size();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+
+/** One FreeRTOS task, backed by a host thread. */
+struct TTSimTask {
+    std::string name;
+    BaseType_t coreId = 0;
+    uint32_t notifyCount = 0;
+    bool blocked = false;
+    uint64_t deadlineUs = UINT64_MAX;       // UINT64_MAX: blocked without timeout
+    std::function<bool()> ready;             // Evaluated under the scheduler lock
+};
+
+/**
+ * Runs FreeRTOS tasks as std::threads behind one lock. Every blocking call (notify take, queue,
+ * delay) goes through block(), which is what lets the virtual clock know when all tasks are idle
+ * and time can jump to the next deadline.
+ */
+class TTSimScheduler {
+public:
+    static TTSimScheduler& instance();
+
+    void setVirtual(bool enable) { _virtual = enable; }
+    bool isVirtual() const { return _virtual; }
+    uint64_t nowUs();
+
+    TTSimTask* create(const char* name, BaseType_t coreId);
+    void remove(TTSimTask* task);
+    static TTSimTask* current();
+    static void setCurrent(TTSimTask* task);
+
+    /** Wait until ready() (checked under the lock) or timeoutMs elapses; false on timeout. */
+    bool block(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, uint32_t timeoutMs);
+    /** Wake blocked tasks so they re-check their conditions; call with the lock held. */
+    void changed() { _cv.notify_all(); }
+    std::mutex& mutex() { return _mutex; }
+
+    /** delay(): a task blocks, the host thread advances the virtual clock (or sleeps). */
+    void sleep(uint32_t ms);
+    void advance(uint32_t ms);
+    void waitIdle();
+
+private:
+    TTSimScheduler() = default;
+    bool _quiescent() const;
+    void _waitQuiescent(std::unique_lock<std::mutex>& lock);
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<TTSimTask*> _tasks;
+    bool _virtual = false;
+    std::atomic<uint64_t> _virtualUs{0};
+};
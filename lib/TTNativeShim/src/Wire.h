@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for the Arduino I2C bus; the simulated sensors do not talk over it
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { (void)sda; (void)scl; (void)frequency; return true; }
+    void end() {}
+    void setClock(uint32_t frequency) { (void)frequency; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,5 @@
+#pragma once
+
+// A host process starts with zeroed statics, like RTC memory after power-on
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
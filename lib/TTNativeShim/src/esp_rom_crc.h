@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+/** Same result as the ESP32 ROM routine: standard reflected CRC-32 (0xEDB88320), crc is the running value. */
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
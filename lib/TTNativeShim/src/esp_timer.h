@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+#include "TTSim.h"
+
+inline int64_t esp_timer_get_time() { return (int64_t)TTSim::micros(); }
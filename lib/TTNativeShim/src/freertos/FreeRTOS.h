@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF FreeRTOS subset used by the firmware (see TTSim.h)
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define pdPASS             pdTRUE
+#define pdFAIL             pdFALSE
+#define errQUEUE_FULL      0
+
+#define portMAX_DELAY      0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+
+#define tskIDLE_PRIORITY   0
+#define tskNO_AFFINITY     0x7FFFFFFF
+
+/** Spinlock; an aggregate so `portMUX_TYPE m = portMUX_INITIALIZER_UNLOCKED;` works as on the ESP32. */
+typedef struct {
+    volatile int locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)      vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)       vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)  vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)   vPortExitCritical(mux)
+#define portYIELD_FROM_ISR()         do {} while (0)
+
+BaseType_t xPortGetCoreID();
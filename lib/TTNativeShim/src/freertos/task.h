@@ -0,0 +1,19 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct TTSimTask;
+typedef TTSimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+/** Starts a host thread; coreId is only reported back through xPortGetCoreID(). */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
@@ -14,6 +14,10 @@ public:
     virtual void setRoot(std::unique_ptr<ITTScreenPage> page) = 0;
     virtual void push(std::unique_ptr<ITTScreenPage> page) = 0;
     virtual void pop() = 0;
+    /** Hint a likely next page; it is built into the page cache during idle UI loops. */
+    virtual void prebuild(std::unique_ptr<ITTScreenPage> page) = 0;
+    /** True when a page with this name is on the stack, in the page cache or waiting to be pre-built. */
+    virtual bool isKnown(const char* name) const = 0;
 
     virtual ITTScreenPage* getCurrentPage() = 0;
     virtual void requestRefresh(ITTScreenPage* page, TTRefreshLevel level = TT_REFRESH_PARTIAL) = 0;
@@ -27,6 +31,12 @@ public:
         push(std::unique_ptr<ITTScreenPage>(page.release()));
     }
 
+    template<typename T>
+    void prebuildPage(std::unique_ptr<T> page) {
+        static_assert(std::is_base_of<ITTScreenPage, T>::value, "T must inherit from ITTScreenPage");
+        prebuild(std::unique_ptr<ITTScreenPage>(page.release()));
+    }
+
     template<typename T>
     void setRootPage(std::unique_ptr<T> page) {
         static_assert(std::is_base_of<ITTScreenPage, T>::value, "T must inherit from ITTScreenPage");
@@ -23,4 +23,7 @@ public:
     virtual void willDestroy() {}
     virtual void willAppear() {}
     virtual void willDisappear() {}
+    virtual void willSuspend() {}
+    virtual void willResume() {}
+    virtual bool isCacheable() const { return true; }
 };
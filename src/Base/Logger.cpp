@@ -2,65 +2,249 @@
 // Created by fanzhang on 2024/6/25.
 //
 #include "Logger.h"
-#include <iostream>
-#include <map>
-#include <cstdarg>
-#include "Util.h"
+#include "TTVTask.h"
+#include <stdio.h>
 #include <Arduino.h>
 
+static const char* const LOG_LEVEL_TAGS[] = { "", "[E]", "[W]", "[I]", "[D]", "[V]" };
+static const char* const LOG_LEVEL_COLORS[] = { "", "\033[31m", "\033[35m", "\033[32m", "\033[34m", "" };
+
+#define TT_LOG_DROPPED_FORMAT "Logger: %u messages dropped on core %u (ring full)"
+
 Logger::Logger() : _level(LOG_LEVEL_INFO) { }
 
 void Logger::setLevel(LogLevel level) {
     _level = level;
 }
 
-void Logger::logLevel(const char* file, int line, LogLevel level, const char* fmt, ...) {
-    if (level > _level)
+void Logger::_putBytes(TTLogRecord& rec, uint8_t type, const void* data, size_t len) {
+    if (rec.argc >= TT_LOG_MAX_ARGS) return;
+    if (rec.used + len > TT_LOG_RECORD_DATA) {
+        len = 0;    // No room: the argument is kept as a placeholder and printed as "?"
+        type = TTLogRecord::ARG_STRING;
+    }
+    rec.types[rec.argc++] = type;
+    memcpy(rec.data + rec.used, data, len);
+    rec.used += len;
+}
+
+void Logger::_putOne(TTLogRecord& rec, const char* value) {
+    if (rec.argc >= TT_LOG_MAX_ARGS) return;
+    if (value == nullptr) value = "(null)";
+    // Stored as length byte + characters, truncated to the space left in the record
+    size_t room = TT_LOG_RECORD_DATA - rec.used;
+    size_t len = strlen(value);
+    if (room == 0) {
+        rec.types[rec.argc++] = TTLogRecord::ARG_STRING;
+        return;
+    }
+    if (len > room - 1) len = room - 1;
+    if (len > TT_LOG_MAX_STRING) len = TT_LOG_MAX_STRING;
+    rec.types[rec.argc++] = TTLogRecord::ARG_STRING;
+    rec.data[rec.used] = (uint8_t)len;
+    memcpy(rec.data + rec.used + 1, value, len);
+    rec.used += len + 1;
+}
+
+void Logger::_submit(TTLogRecord& rec) {
+    rec.timeMs = millis();
+
+    if (_drainTask == nullptr || rec.level == LOG_LEVEL_ERROR) {
+        // Errors are written in place (after anything already queued, to keep order)
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        for (uint8_t c = 0; c < TT_LOG_CORE_COUNT; c++) {
+            TTLogRecord queued;
+            while (_rings[c].pop(queued)) _write(queued);
+        }
+        _write(rec);
         return;
+    }
+
+    _rings[xPortGetCoreID() % TT_LOG_CORE_COUNT].push(rec);
+    _drainTask->wake();
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> lock(_drainMutex);
+    TTLogRecord rec;
+    for (uint8_t c = 0; c < TT_LOG_CORE_COUNT; c++) {
+        while (_rings[c].pop(rec)) _write(rec);
+
+        uint32_t dropped = _rings[c].takeDropped();
+        if (dropped > 0) {
+            rec.timeMs = millis();
+            rec.file = TT_LOG_BINARY ? nullptr : __FILENAME__;
+            rec.fileId = TT_LOG_FILE_ID;
+            rec.line = __LINE__;
+            rec.level = LOG_LEVEL_WARN;
+            rec.fmt = TT_LOG_BINARY ? nullptr : TT_LOG_DROPPED_FORMAT;
+            rec.fmtId = TT_LOG_FORMAT_ID(TT_LOG_DROPPED_FORMAT);
+            rec.argc = 0;
+            rec.used = 0;
+            _put(rec, (unsigned)dropped, (unsigned)c);
+            _write(rec);
+        }
+    }
+}
+
+/*
+ * Re-expands rec.fmt one conversion at a time, passing each captured argument to snprintf with its
+ * own conversion spec. Length modifiers select the C type the caller originally passed.
+ */
+size_t Logger::_formatMessage(const TTLogRecord& rec, char* out, size_t size) {
+    size_t pos = 0;
+    uint8_t arg = 0;
+    size_t offset = 0;
+    const char* p = rec.fmt;
+
+    while (*p != '\0' && pos + 1 < size) {
+        if (*p != '%') {
+            out[pos++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[pos++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Collect one conversion spec: %[flags][width][.precision][length]conversion. A '*' width or
+        // precision takes the next (integer) argument and is written into the spec as digits.
+        char spec[24];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.hlLzjt*", *p) != nullptr && n < sizeof(spec) - 2) {
+            if (*p != '*') {
+                spec[n++] = *p++;
+                continue;
+            }
+            p++;
+            uint8_t starType = arg < rec.argc ? rec.types[arg] : 0xFF;
+            int64_t star = 0;
+            if (starType == TTLogRecord::ARG_INT || starType == TTLogRecord::ARG_UINT) {
+                memcpy(&star, rec.data + offset, sizeof(star));
+                offset += sizeof(star);
+                arg++;
+            }
+            int digits = snprintf(spec + n, sizeof(spec) - 1 - n, "%d", (int)star);
+            if (digits > 0) n += (size_t)digits < sizeof(spec) - 1 - n ? (size_t)digits : sizeof(spec) - 2 - n;
+        }
+        if (*p == '\0') break;
+        char conv = *p++;
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        bool longLong = strstr(spec, "ll") != nullptr || strchr(spec, 'j') != nullptr;
+        bool isLong = !longLong && strchr(spec, 'l') != nullptr;
+        bool isSize = strchr(spec, 'z') != nullptr || strchr(spec, 't') != nullptr;
+
+        char* dst = out + pos;
+        size_t room = size - pos;
+        int written = 0;
+        uint8_t type = arg < rec.argc ? rec.types[arg] : 0xFF;
+        const uint8_t* data = rec.data + offset;
+
+        if (type == TTLogRecord::ARG_STRING && conv == 's') {
+            size_t len = offset < rec.used ? data[0] : 0;
+            char str[TT_LOG_RECORD_DATA];
+            memcpy(str, data + 1, len);
+            str[len] = '\0';
+            written = snprintf(dst, room, spec, str);
+            offset += offset < rec.used ? len + 1 : 0;
+        } else if ((type == TTLogRecord::ARG_INT || type == TTLogRecord::ARG_UINT) && strchr("dicuxXo", conv) != nullptr) {
+            int64_t v;
+            memcpy(&v, data, sizeof(v));
+            if (longLong) written = snprintf(dst, room, spec, (long long)v);
+            else if (isLong) written = snprintf(dst, room, spec, (long)v);
+            else if (isSize) written = snprintf(dst, room, spec, (size_t)v);
+            else written = snprintf(dst, room, spec, (int)v);
+            offset += sizeof(v);
+        } else if (type == TTLogRecord::ARG_DOUBLE && strchr("fFeEgGaA", conv) != nullptr) {
+            double v;
+            memcpy(&v, data, sizeof(v));
+            written = snprintf(dst, room, spec, v);
+            offset += sizeof(v);
+        } else if (type == TTLogRecord::ARG_POINTER && conv == 'p') {
+            const void* v;
+            memcpy(&v, data, sizeof(v));
+            written = snprintf(dst, room, spec, v);
+            offset += sizeof(v);
+        } else {
+            // Missing or mismatched argument: skip its bytes and print a placeholder
+            if (type == TTLogRecord::ARG_STRING) offset += offset < rec.used ? data[0] + 1 : 0;
+            else if (type == TTLogRecord::ARG_POINTER) offset += sizeof(void*);
+            else if (type != 0xFF) offset += 8;
+            written = snprintf(dst, room, "?");
+        }
+        if (type != 0xFF) arg++;
+        if (written > 0) pos += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+void Logger::_write(const TTLogRecord& rec) {
+#if TT_LOG_BINARY
+    _writeBinary(rec);
+#else
+    _writeText(rec);
+#endif
+}
+
+void Logger::_writeText(const TTLogRecord& rec) {
+    char msg[256];
+    _formatMessage(rec, msg, sizeof(msg));
+
+    const unsigned long secs = rec.timeMs / 1000;
+    uint8_t level = rec.level <= (uint8_t)LOG_LEVEL_VERBOSE ? rec.level : (uint8_t)LOG_LEVEL_VERBOSE;
+    char line[320];
+    int len = snprintf(line, sizeof(line), "%s[%02lu:%02lu:%02lu.%03lu]%s[%s:%u]: %s\033[0m\n",
+                       LOG_LEVEL_COLORS[level],
+                       (secs % 86400) / 3600, (secs / 60) % 60, secs % 60, (unsigned long)(rec.timeMs % 1000),
+                       LOG_LEVEL_TAGS[level], rec.file, (unsigned)rec.line, msg);
+    if (len <= 0) return;
+    if ((size_t)len >= sizeof(line)) len = sizeof(line) - 1;
+    fwrite(line, 1, (size_t)len, stdout);
+    fflush(stdout);
+}
+
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
 
-    va_list args;
-    va_start(args, fmt);
-    std::string msg = Util::format(fmt, args);
-    va_end(args);
-
-    static std::map<LogLevel, std::string> levelMap = {
-            { LOG_LEVEL_ERROR, "[E]" },
-            { LOG_LEVEL_WARN, "[W]" },
-            { LOG_LEVEL_INFO, "[I]" },
-            { LOG_LEVEL_DEBUG, "[D]" },
-            { LOG_LEVEL_VERBOSE, "[V]" },
-    };
-
-    static std::map<LogLevel, std::string> colorMap = {
-            { LOG_LEVEL_ERROR, "\033[31m" },
-            { LOG_LEVEL_WARN, "\033[35m" },
-            { LOG_LEVEL_INFO, "\033[32m" },
-            { LOG_LEVEL_DEBUG, "\033[34m" },
-            { LOG_LEVEL_VERBOSE, "" },
-    };
-
-    // Division constants
-    const unsigned long MSECS_PER_SEC       = 1000;
-    const unsigned long SECS_PER_MIN        = 60;
-    const unsigned long SECS_PER_HOUR       = 3600;
-    const unsigned long SECS_PER_DAY        = 86400;
-
-    // Total time
-    const unsigned long msecs               =  millis() ;
-    const unsigned long secs                =  msecs / MSECS_PER_SEC;
-
-    // Time in components
-    const unsigned long MiliSeconds         =  msecs % MSECS_PER_SEC;
-    const unsigned long Seconds             =  secs  % SECS_PER_MIN ;
-    const unsigned long Minutes             = (secs  / SECS_PER_MIN) % SECS_PER_MIN;
-    const unsigned long Hours               = (secs  % SECS_PER_DAY) / SECS_PER_HOUR;
-
-    // Time as string
-    std::string timestamp = Util::format("%02d:%02d:%02d.%03d", Hours, Minutes, Seconds, MiliSeconds);
-    std::string output = Util::format(
-            "%s[%s]%s[%s:%d]: %s\033[0m",
-            colorMap[level].c_str(), timestamp.c_str(), levelMap[level].c_str(), file, line, msg.c_str());
-    std::cout << output << std::endl;
+/*
+ * Frame layout, little-endian (see tools/log_decode.py):
+ *   A5 5A | level u8 | argc u8 | used u8 | line u16 | timeMs u32 | fileId u32 | fmtId u32
+ *   | types, two 4-bit codes per byte | data[used] | crc8 of everything after the sync bytes
+ * Anything else on the UART (ROM boot messages, library prints) passes through the decoder as text.
+ */
+void Logger::_writeBinary(const TTLogRecord& rec) {
+    uint8_t frame[2 + 17 + TT_LOG_MAX_ARGS / 2 + TT_LOG_RECORD_DATA + 1];
+    size_t n = 0;
+    frame[n++] = TT_LOG_FRAME_SYNC0;
+    frame[n++] = TT_LOG_FRAME_SYNC1;
+    frame[n++] = rec.level;
+    frame[n++] = rec.argc;
+    frame[n++] = rec.used;
+    memcpy(frame + n, &rec.line, 2);    n += 2;
+    memcpy(frame + n, &rec.timeMs, 4);  n += 4;
+    memcpy(frame + n, &rec.fileId, 4);  n += 4;
+    memcpy(frame + n, &rec.fmtId, 4);   n += 4;
+    for (uint8_t i = 0; i < rec.argc; i += 2) {
+        uint8_t hi = i + 1 < rec.argc ? rec.types[i + 1] : 0;
+        frame[n++] = (uint8_t)((rec.types[i] & 0x0F) | (hi << 4));
+    }
+    memcpy(frame + n, rec.data, rec.used);
+    n += rec.used;
+    frame[n] = crc8(frame + 2, n - 2);
+    n++;
+    fwrite(frame, 1, n, stdout);
+    fflush(stdout);
 }
 
-Logger _logger;
\ No newline at end of file
+Logger _logger;
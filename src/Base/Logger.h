@@ -7,11 +7,21 @@
 
 #include <cstdarg>
 #include <string.h>
+#include <stdint.h>
+#include <type_traits>
+#include <mutex>
+#include "TTMpscRing.h"
 
 #ifndef __FILENAME__
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 #endif
 
+#define TT_LOG_MAX_ARGS       8
+#define TT_LOG_RECORD_DATA    84    // Argument bytes per record
+#define TT_LOG_MAX_STRING     48    // Longer string arguments are truncated
+#define TT_LOG_RING_SIZE      32    // Records per core, power of two
+#define TT_LOG_CORE_COUNT     2
+
 enum LogLevel {
     LOG_LEVEL_NONE,       /*!< No log output */
     LOG_LEVEL_ERROR,      /*!< Critical errors, software module can not recover on its own */
@@ -21,41 +31,217 @@ enum LogLevel {
     LOG_LEVEL_VERBOSE     /*!< Bigger chunks of debugging information, or frequent messages which can potentially flood the output. */
 };
 
+/*
+ * Compile-time thresholds. A call above its module's threshold compiles to nothing: the arguments are
+ * not evaluated and the format string is not linked. A translation unit selects its module with
+ * "#define TT_LOG_MODULE EPD" before its first #include; files without one use TT_LOG_LEVEL_DEFAULT.
+ * Set from build_flags by name or number, e.g. -D TT_LOG_LEVEL_EPD=WARN, -D TT_LOG_LEVEL_DEFAULT=INFO.
+ * The runtime level (setLevel) filters further.
+ */
+#define TT_LOG_LEVEL_ID_NONE      0
+#define TT_LOG_LEVEL_ID_ERROR     1
+#define TT_LOG_LEVEL_ID_WARN      2
+#define TT_LOG_LEVEL_ID_INFO      3
+#define TT_LOG_LEVEL_ID_DEBUG     4
+#define TT_LOG_LEVEL_ID_VERBOSE   5
+#define TT_LOG_LEVEL_ID_0         0
+#define TT_LOG_LEVEL_ID_1         1
+#define TT_LOG_LEVEL_ID_2         2
+#define TT_LOG_LEVEL_ID_3         3
+#define TT_LOG_LEVEL_ID_4         4
+#define TT_LOG_LEVEL_ID_5         5
+
+#ifndef TT_LOG_LEVEL_DEFAULT
+#define TT_LOG_LEVEL_DEFAULT      DEBUG
+#endif
+#ifndef TT_LOG_LEVEL_EPD
+#define TT_LOG_LEVEL_EPD          TT_LOG_LEVEL_DEFAULT    // Panel driver, refresh timing
+#endif
+#ifndef TT_LOG_LEVEL_UI
+#define TT_LOG_LEVEL_UI           TT_LOG_LEVEL_DEFAULT    // UI task, pages, navigation, widgets
+#endif
+#ifndef TT_LOG_LEVEL_KEYPAD
+#define TT_LOG_LEVEL_KEYPAD       TT_LOG_LEVEL_DEFAULT
+#endif
+#ifndef TT_LOG_LEVEL_SENSOR
+#define TT_LOG_LEVEL_SENSOR       TT_LOG_LEVEL_DEFAULT    // Sensor task and history
+#endif
+#ifndef TT_LOG_LEVEL_STORAGE
+#define TT_LOG_LEVEL_STORAGE      TT_LOG_LEVEL_DEFAULT    // LittleFS, preferences, NVS
+#endif
+#ifndef TT_LOG_LEVEL_WIFI
+#define TT_LOG_LEVEL_WIFI         TT_LOG_LEVEL_DEFAULT
+#endif
+#ifndef TT_LOG_LEVEL_FONT
+#define TT_LOG_LEVEL_FONT         TT_LOG_LEVEL_DEFAULT
+#endif
+#ifndef TT_LOG_LEVEL_NOTIFY
+#define TT_LOG_LEVEL_NOTIFY       TT_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef TT_LOG_MODULE
+#define TT_LOG_MODULE             DEFAULT
+#endif
+
+#define TT_LOG_PASTE_(a, b)       a##b
+#define TT_LOG_PASTE(a, b)        TT_LOG_PASTE_(a, b)
+#define TT_LOG_LEVEL_VALUE(name)  TT_LOG_PASTE(TT_LOG_LEVEL_ID_, name)
+/** Threshold of the module being compiled, resolved at the call site. */
+#define TT_LOG_COMPILED_LEVEL     TT_LOG_LEVEL_VALUE(TT_LOG_PASTE(TT_LOG_LEVEL_, TT_LOG_MODULE))
+
+/*
+ * Binary output (-D TT_LOG_BINARY=1): records are written as frames carrying a hash of the format
+ * string and of the source file name plus the raw argument bytes; neither string is linked into the
+ * firmware. tools/log_decode.py rebuilds the text from the sources.
+ */
+#ifndef TT_LOG_BINARY
+#define TT_LOG_BINARY             0
+#endif
+
+#define TT_LOG_FRAME_SYNC0        0xA5
+#define TT_LOG_FRAME_SYNC1        0x5A
+
+/** FNV-1a, as used for notification names; must match tools/log_decode.py. */
+constexpr uint32_t ttLogHash(const char* s, uint32_t h = 2166136261u) {
+    return *s ? ttLogHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+constexpr const char* ttLogBasename(const char* s, const char* last) {
+    return *s ? ttLogBasename(s + 1, *s == '/' || *s == '\\' ? s + 1 : last) : last;
+}
+
+#define TT_LOG_FORMAT_ID(fmt)     (std::integral_constant<uint32_t, ttLogHash(fmt)>::value)
+#define TT_LOG_FILE_ID            (std::integral_constant<uint32_t, ttLogHash(ttLogBasename(__FILE__, __FILE__))>::value)
+
+#if TT_LOG_BINARY
+#define TT_LOG_CALL(level, fmt, ...) \
+    _logger.logLevel(nullptr, TT_LOG_FILE_ID, __LINE__, level, nullptr, TT_LOG_FORMAT_ID(fmt), ##__VA_ARGS__)
+#else
+#define TT_LOG_CALL(level, fmt, ...) \
+    _logger.logLevel(__FILENAME__, 0, __LINE__, level, fmt, 0, ##__VA_ARGS__)
+#endif
+
 #define LOG_E(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__); \
+    if (TT_LOG_COMPILED_LEVEL >= LOG_LEVEL_ERROR) TT_LOG_CALL(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__); \
 } while(0)
 
 #define LOG_W(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__); \
+    if (TT_LOG_COMPILED_LEVEL >= LOG_LEVEL_WARN) TT_LOG_CALL(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__); \
 } while(0)
 
 #define LOG_I(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__); \
+    if (TT_LOG_COMPILED_LEVEL >= LOG_LEVEL_INFO) TT_LOG_CALL(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__); \
 } while(0)
 
 #define LOG_D(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__); \
+    if (TT_LOG_COMPILED_LEVEL >= LOG_LEVEL_DEBUG) TT_LOG_CALL(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__); \
 } while(0)
 
 #define LOG_V(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_VERBOSE, fmt, ##__VA_ARGS__); \
+    if (TT_LOG_COMPILED_LEVEL >= LOG_LEVEL_VERBOSE) TT_LOG_CALL(LOG_LEVEL_VERBOSE, fmt, ##__VA_ARGS__); \
 } while(0)
 
-#define LOG_I(fmt, ...) do { \
-    _logger.logLevel(__FILENAME__, __LINE__, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__); \
-} while(0)
+/**
+ * One captured log call: the format pointer (must be a string literal) plus the raw arguments.
+ * Strings are copied, since callers often pass temporaries like String::c_str(), up to their NUL and at most
+ * TT_LOG_MAX_STRING bytes. '*' widths and precisions take their integer argument in both text and binary
+ * mode, but the copy ignores them: %.*s needs a NUL-terminated string, it cannot print a slice of a buffer.
+ * With TT_LOG_BINARY, fmt and file are null and fmtId / fileId identify them instead.
+ */
+struct TTLogRecord {
+    enum ArgType : uint8_t { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_STRING, ARG_POINTER };
 
+    uint32_t timeMs;
+    const char* fmt;
+    const char* file;
+    uint32_t fmtId;
+    uint32_t fileId;
+    uint16_t line;
+    uint8_t level;
+    uint8_t argc;
+    uint8_t used;
+    uint8_t types[TT_LOG_MAX_ARGS];
+    uint8_t data[TT_LOG_RECORD_DATA];
+};
+
+class TTVTask;
+
+/**
+ * Deferred logger. logLevel() only captures a TTLogRecord into a lock-free ring for the caller's core
+ * (a few microseconds); the drain task (TTLogTask) formats and writes to the UART and reports drops.
+ * Until a drain task is attached, and for errors, records are written synchronously so nothing is
+ * lost before an assert or restart.
+ */
 class Logger {
 public:
     Logger();
     void setLevel(LogLevel level);
-    void logLevel(const char* file, int line, LogLevel level, const char* fmt, ...);
+
+    /** Called through the LOG_x macros. */
+    template<typename... Args>
+    void logLevel(const char* file, uint32_t fileId, int line, LogLevel level, const char* fmt, uint32_t fmtId, Args... args);
+
+    /** Drain side: set the task woken on new records, and write out everything queued. */
+    void attachDrainTask(TTVTask* task) { _drainTask = task; }
+    void drain();
 
 private:
+    void _submit(TTLogRecord& rec);
+    void _write(const TTLogRecord& rec);
+    void _writeText(const TTLogRecord& rec);
+    void _writeBinary(const TTLogRecord& rec);
+    size_t _formatMessage(const TTLogRecord& rec, char* out, size_t size);
+
+    static void _put(TTLogRecord&) {}
+    template<typename T, typename... Rest>
+    static void _put(TTLogRecord& rec, T value, Rest... rest) {
+        _putOne(rec, value);
+        _put(rec, rest...);
+    }
+
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    _putOne(TTLogRecord& rec, T value) {
+        if (std::is_signed<T>::value || std::is_enum<T>::value) {
+            int64_t v = (int64_t)value;
+            _putBytes(rec, TTLogRecord::ARG_INT, &v, sizeof(v));
+        } else {
+            uint64_t v = (uint64_t)value;
+            _putBytes(rec, TTLogRecord::ARG_UINT, &v, sizeof(v));
+        }
+    }
+    static void _putOne(TTLogRecord& rec, double value) { _putBytes(rec, TTLogRecord::ARG_DOUBLE, &value, sizeof(value)); }
+    static void _putOne(TTLogRecord& rec, const char* value);
+    static void _putOne(TTLogRecord& rec, char* value) { _putOne(rec, (const char*)value); }
+    static void _putOne(TTLogRecord& rec, const void* value) { _putBytes(rec, TTLogRecord::ARG_POINTER, &value, sizeof(value)); }
+    static void _putOne(TTLogRecord& rec, void* value) { _putOne(rec, (const void*)value); }
+    static void _putBytes(TTLogRecord& rec, uint8_t type, const void* data, size_t len);
+
     LogLevel _level;
+    TTVTask* _drainTask = nullptr;
+    std::mutex _drainMutex;   // Single consumer: the drain task, or an error written in place
+    TTMpscRing<TTLogRecord, TT_LOG_RING_SIZE> _rings[TT_LOG_CORE_COUNT];
 };
 
 extern Logger _logger;
 
+template<typename... Args>
+void Logger::logLevel(const char* file, uint32_t fileId, int line, LogLevel level, const char* fmt, uint32_t fmtId, Args... args) {
+    static_assert(sizeof...(Args) <= TT_LOG_MAX_ARGS, "Too many log arguments (TT_LOG_MAX_ARGS)");
+    if (level > _level)
+        return;
+
+    TTLogRecord rec;
+    rec.file = file;
+    rec.fileId = fileId;
+    rec.line = (uint16_t)line;
+    rec.level = (uint8_t)level;
+    rec.fmt = fmt;
+    rec.fmtId = fmtId;
+    rec.argc = 0;
+    rec.used = 0;
+    _put(rec, args...);
+    _submit(rec);
+}
 
 #endif //NIKONQCPRO_LOGGER_H
@@ -0,0 +1,274 @@
+#define TT_LOG_MODULE UI
+
+#include "TTDigitLabel.h"
+#include "TTDrawBufPassthroughDecoder.h"
+#include "Logger.h"
+#include <cstring>
+
+#include "core/lv_obj_private.h"
+#include "core/lv_obj_class_private.h"
+#include "misc/lv_area_private.h"
+
+#define MY_CLASS (&tt_digit_label_class)
+#define GLYPH_COUNT (sizeof(TT_DIGIT_LABEL_CHARSET) - 1)
+
+struct tt_digit_label_t {
+    lv_obj_t obj;
+    uint8_t* strip;                         // lv_malloc'd, I1 rows of every glyph, 1 = white
+    lv_draw_buf_t glyphs[GLYPH_COUNT];      // Views into strip, drawn as-is
+    int32_t height;
+    uint8_t cells[TT_DIGIT_LABEL_MAX_CELLS];    // Glyph index per character
+    uint8_t count;
+};
+
+static void constructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void destructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void event_cb(const lv_obj_class_t* class_p, lv_event_t* e);
+static void draw_main(lv_event_t* e);
+
+static uint8_t glyph_index(char ch);
+static int32_t cell_width(const tt_digit_label_t* dl, uint8_t glyph);
+static void update_size(tt_digit_label_t* dl);
+static void invalidate_cells(lv_obj_t* obj, int32_t x1, int32_t x2);
+
+const lv_obj_class_t tt_digit_label_class = {
+    .base_class = &lv_obj_class,
+    .constructor_cb = constructor,
+    .destructor_cb = destructor,
+    .event_cb = event_cb,
+    .user_data = nullptr,
+    .name = "tt_digit_label",
+    .width_def = LV_SIZE_CONTENT,
+    .height_def = LV_SIZE_CONTENT,
+    .editable = LV_OBJ_CLASS_EDITABLE_INHERIT,
+    .group_def = LV_OBJ_CLASS_GROUP_DEF_INHERIT,
+    .instance_size = sizeof(tt_digit_label_t),
+    .theme_inheritable = LV_OBJ_CLASS_THEME_INHERITABLE_TRUE,
+};
+
+lv_obj_t* tt_digit_label_create(lv_obj_t* parent) {
+    lv_obj_t* obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    if (!obj) return nullptr;
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+bool tt_digit_label_set_font(lv_obj_t* obj, const lv_font_t* font) {
+    tt_digit_label_t* dl = (tt_digit_label_t*)obj;
+    if (!font) return false;
+
+    // Advances and the ink box shared by all glyphs: top / bottom relative to the baseline
+    lv_font_glyph_dsc_t dsc[GLYPH_COUNT];
+    int32_t advance[GLYPH_COUNT];
+    int32_t digit_w = 0;
+    int32_t top = INT32_MIN, bottom = INT32_MAX;
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++) {
+        char ch = TT_DIGIT_LABEL_CHARSET[i];
+        memset(&dsc[i], 0, sizeof(dsc[i]));
+        if (ch == ' ') continue;
+        if (!lv_font_get_glyph_dsc(font, &dsc[i], (uint32_t)ch, 0)) {
+            LOG_E("TTDigitLabel: font has no '%c'", ch);
+            return false;
+        }
+        advance[i] = dsc[i].adv_w;
+        if (ch >= '0' && ch <= '9' && advance[i] > digit_w) digit_w = advance[i];
+        if (dsc[i].box_h == 0) continue;
+        if (dsc[i].ofs_y + dsc[i].box_h > top) top = dsc[i].ofs_y + dsc[i].box_h;
+        if (dsc[i].ofs_y < bottom) bottom = dsc[i].ofs_y;
+    }
+    if (top <= bottom) return false;
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++) {
+        char ch = TT_DIGIT_LABEL_CHARSET[i];
+        if (ch == ' ' || (ch >= '0' && ch <= '9')) advance[i] = digit_w;
+    }
+
+    int32_t h = top - bottom;
+    size_t size = 0;
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++) size += (size_t)((advance[i] + 7) / 8) * (size_t)h;
+    uint8_t* strip = (uint8_t*)lv_malloc(size);
+    if (!strip) {
+        LOG_E("TTDigitLabel: no memory for a %u byte strip", (unsigned)size);
+        return false;
+    }
+    memset(strip, 0xFF, size);
+
+    uint8_t* p = strip;
+    for (uint8_t i = 0; i < GLYPH_COUNT; i++) {
+        int32_t stride = (advance[i] + 7) / 8;
+        if (dsc[i].box_w > 0 && dsc[i].box_h > 0) {
+            // Glyph bitmaps come as A8 draw buffers; ink is anything at least half covered
+            lv_draw_buf_t* tmp = lv_draw_buf_create(dsc[i].box_w, dsc[i].box_h, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+            const lv_draw_buf_t* bmp = (const lv_draw_buf_t*)lv_font_get_glyph_bitmap(&dsc[i], tmp);
+            if (bmp && bmp->header.cf == LV_COLOR_FORMAT_A8) {
+                int32_t row0 = top - (dsc[i].ofs_y + dsc[i].box_h);
+                for (int32_t r = 0; r < dsc[i].box_h; r++) {
+                    const uint8_t* src = bmp->data + (size_t)r * bmp->header.stride;
+                    for (int32_t c = 0; c < dsc[i].box_w; c++) {
+                        int32_t x = dsc[i].ofs_x + c;
+                        if (src[c] < 0x80 || x < 0 || x >= advance[i]) continue;
+                        p[(size_t)(row0 + r) * stride + (x >> 3)] &= (uint8_t)~(0x80 >> (x & 7));
+                    }
+                }
+            } else {
+                LOG_W("TTDigitLabel: no A8 bitmap for '%c'", TT_DIGIT_LABEL_CHARSET[i]);
+            }
+            lv_font_glyph_release_draw_data(&dsc[i]);
+            if (tmp) lv_draw_buf_destroy(tmp);
+        }
+
+        lv_draw_buf_t* g = &dl->glyphs[i];
+        memset(g, 0, sizeof(*g));
+        g->header.magic = LV_IMAGE_HEADER_MAGIC;
+        g->header.cf = LV_COLOR_FORMAT_I1;
+        g->header.flags = TT_DRAW_BUF_PASSTHROUGH_FLAG;
+        g->header.w = advance[i];
+        g->header.h = h;
+        g->header.stride = (uint32_t)stride;
+        g->data_size = (uint32_t)(stride * h);
+        g->data = p;
+        g->unaligned_data = p;
+        g->handlers = TTDrawBufPassthroughDecoder_get_handlers();
+        p += stride * h;
+    }
+
+    if (dl->strip) lv_free(dl->strip);
+    dl->strip = strip;
+    dl->height = h;
+    update_size(dl);
+    lv_obj_invalidate(obj);
+    return true;
+}
+
+void tt_digit_label_set_text(lv_obj_t* obj, const char* text) {
+    tt_digit_label_t* dl = (tt_digit_label_t*)obj;
+    uint8_t cells[TT_DIGIT_LABEL_MAX_CELLS];
+    uint8_t count = 0;
+    for (const char* s = text; *s && count < TT_DIGIT_LABEL_MAX_CELLS; s++) {
+        cells[count++] = glyph_index(*s);
+    }
+
+    bool same_pattern = count == dl->count;
+    for (uint8_t i = 0; same_pattern && i < count; i++) {
+        same_pattern = cell_width(dl, cells[i]) == cell_width(dl, dl->cells[i]);
+    }
+    if (!same_pattern || !dl->strip) {
+        memcpy(dl->cells, cells, count);
+        dl->count = count;
+        update_size(dl);
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    // Only the cells whose glyph changed; neighbours that both changed share one area
+    int32_t x = 0;
+    int32_t dirty_x1 = -1, dirty_x2 = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t w = cell_width(dl, cells[i]);
+        if (cells[i] != dl->cells[i]) {
+            if (dirty_x1 >= 0 && x == dirty_x2 + 1) {
+                dirty_x2 = x + w - 1;
+            } else {
+                if (dirty_x1 >= 0) invalidate_cells(obj, dirty_x1, dirty_x2);
+                dirty_x1 = x;
+                dirty_x2 = x + w - 1;
+            }
+        }
+        x += w;
+    }
+    if (dirty_x1 >= 0) invalidate_cells(obj, dirty_x1, dirty_x2);
+    memcpy(dl->cells, cells, count);
+}
+
+static void constructor(const lv_obj_class_t* class_p, lv_obj_t* obj) {
+    LV_UNUSED(class_p);
+    tt_digit_label_t* dl = (tt_digit_label_t*)obj;
+    dl->strip = nullptr;
+    dl->height = 0;
+    dl->count = 0;
+    lv_obj_set_style_pad_all(obj, 0, 0);
+    lv_obj_set_style_border_width(obj, 0, 0);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, 0);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+}
+
+static void destructor(const lv_obj_class_t* class_p, lv_obj_t* obj) {
+    LV_UNUSED(class_p);
+    tt_digit_label_t* dl = (tt_digit_label_t*)obj;
+    if (dl->strip) lv_free(dl->strip);
+    dl->strip = nullptr;
+}
+
+static void event_cb(const lv_obj_class_t* class_p, lv_event_t* e) {
+    lv_result_t res = lv_obj_event_base(class_p, e);
+    if (res != LV_RESULT_OK) return;
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_DRAW_MAIN) {
+        draw_main(e);
+    }
+}
+
+static uint8_t glyph_index(char ch) {
+    const char* hit = ch != '\0' ? strchr(TT_DIGIT_LABEL_CHARSET, ch) : nullptr;
+    if (!hit) {
+        LOG_W("TTDigitLabel: '%c' not in the charset", ch);
+        hit = strchr(TT_DIGIT_LABEL_CHARSET, ' ');
+    }
+    return (uint8_t)(hit - TT_DIGIT_LABEL_CHARSET);
+}
+
+static int32_t cell_width(const tt_digit_label_t* dl, uint8_t glyph) {
+    return dl->strip ? (int32_t)dl->glyphs[glyph].header.w : 0;
+}
+
+static void update_size(tt_digit_label_t* dl) {
+    int32_t w = 0;
+    for (uint8_t i = 0; i < dl->count; i++) w += cell_width(dl, dl->cells[i]);
+    lv_obj_set_size((lv_obj_t*)dl, w, dl->height);
+}
+
+static void invalidate_cells(lv_obj_t* obj, int32_t x1, int32_t x2) {
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t area;
+    area.x1 = coords.x1 + x1;
+    area.x2 = coords.x1 + x2;
+    area.y1 = coords.y1;
+    area.y2 = coords.y2;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static void draw_main(lv_event_t* e) {
+    lv_obj_t* obj = (lv_obj_t*)lv_event_get_current_target(e);
+    tt_digit_label_t* dl = (tt_digit_label_t*)obj;
+    if (!dl->strip) return;
+
+    lv_layer_t* layer = lv_event_get_layer(e);
+    lv_area_t obj_coords;
+    lv_obj_get_coords(obj, &obj_coords);
+
+    lv_draw_image_dsc_t draw_dsc;
+    lv_draw_image_dsc_init(&draw_dsc);
+    draw_dsc.base.layer = layer;
+    lv_obj_init_draw_image_dsc(obj, LV_PART_MAIN, &draw_dsc);
+    draw_dsc.opa = LV_OPA_COVER;
+    draw_dsc.rotation = 0;
+    draw_dsc.scale_x = LV_SCALE_NONE;
+    draw_dsc.scale_y = LV_SCALE_NONE;
+
+    lv_area_t cell;
+    cell.x1 = obj_coords.x1;
+    cell.y1 = obj_coords.y1;
+    cell.y2 = obj_coords.y1 + dl->height - 1;
+    for (uint8_t i = 0; i < dl->count; i++) {
+        const lv_draw_buf_t* g = &dl->glyphs[dl->cells[i]];
+        cell.x2 = cell.x1 + (int32_t)g->header.w - 1;
+        lv_area_t clip;
+        if (lv_area_intersect(&clip, &cell, &layer->_clip_area)) {
+            draw_dsc.src = g;
+            draw_dsc.image_area = cell;
+            lv_draw_image(layer, &draw_dsc, &cell);
+        }
+        cell.x1 = cell.x2 + 1;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <lvgl.h>
+
+/*
+ * Fixed-advance numeric label for large clock / counter numerals. tt_digit_label_set_font() renders
+ * the characters of TT_DIGIT_LABEL_CHARSET once into a 1bpp strip (one I1 image per glyph, cropped to
+ * the digits' ink height); drawing blits those images through the passthrough decoder, so the font is
+ * not read again.
+ *
+ * Every character owns a cell: digits and spaces share the widest digit advance, other characters keep
+ * their own, so a cell never moves while the pattern of the text stays the same (e.g. "HH:MM").
+ * tt_digit_label_set_text() invalidates only the cells whose character changed; a different pattern
+ * resizes and invalidates the whole widget. Black on white, text styles are ignored.
+ */
+
+#define TT_DIGIT_LABEL_CHARSET    "0123456789:.- "
+#define TT_DIGIT_LABEL_MAX_CELLS  8
+
+typedef struct tt_digit_label_t tt_digit_label_t;
+
+lv_obj_t* tt_digit_label_create(lv_obj_t* parent);
+
+/** Builds the glyph strip from font (LVGL pool); false if a glyph is missing. The text is kept. */
+bool tt_digit_label_set_font(lv_obj_t* obj, const lv_font_t* font);
+/** Characters outside TT_DIGIT_LABEL_CHARSET are shown as spaces; at most TT_DIGIT_LABEL_MAX_CELLS. */
+void tt_digit_label_set_text(lv_obj_t* obj, const char* text);
+
+extern const lv_obj_class_t tt_digit_label_class;
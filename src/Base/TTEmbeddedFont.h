@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Glyphs of the hot fonts compiled into flash rodata (tools/embed_fonts.py -> TTEmbeddedFontData.cpp).
+ * Bitmaps are A8 (0x00 / 0xFF) like TTFontLoader's output, so LVGL draws them in place: no file
+ * handle, seek or copy. Glyphs are sorted by unicode.
+ */
+struct TTEmbeddedGlyph {
+    uint32_t unicode;
+    uint16_t adv_w;
+    uint8_t box_w;
+    uint8_t box_h;
+    int8_t ofs_x;
+    int8_t ofs_y;
+    uint32_t bitmap;        // Offset into TTEmbeddedFont::bitmaps, box_w * box_h bytes
+};
+
+struct TTEmbeddedFont {
+    int size;
+    uint16_t ascent;        // Metrics of the .bin the tables were built from
+    int16_t descent;
+    const TTEmbeddedGlyph* glyphs;
+    uint16_t count;
+    const uint8_t* bitmaps;
+
+    const TTEmbeddedGlyph* find(uint32_t unicode) const {
+        uint16_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint16_t mid = (uint16_t)((lo + hi) / 2);
+            if (glyphs[mid].unicode < unicode) lo = (uint16_t)(mid + 1);
+            else hi = mid;
+        }
+        return (lo < count && glyphs[lo].unicode == unicode) ? &glyphs[lo] : nullptr;
+    }
+};
+
+/** Embedded subset for a TTFontManager size, nullptr if that size is file-only. */
+const TTEmbeddedFont* TTEmbeddedFont_find(int size);
@@ -0,0 +1,62 @@
+#include "TTFastRegions.h"
+#include <stdio.h>
+
+static bool overlaps(const lv_area_t& a, const lv_area_t& b) {
+    return a.x1 <= b.x2 && b.x1 <= a.x2 && a.y1 <= b.y2 && b.y1 <= a.y2;
+}
+
+static void join(lv_area_t& into, const lv_area_t& area) {
+    if (area.x1 < into.x1) into.x1 = area.x1;
+    if (area.y1 < into.y1) into.y1 = area.y1;
+    if (area.x2 > into.x2) into.x2 = area.x2;
+    if (area.y2 > into.y2) into.y2 = area.y2;
+}
+
+void TTFastRegions::add(const lv_area_t& area) {
+    _updates++;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (overlaps(_regions[i].area, area)) {
+            join(_regions[i].area, area);
+            _regions[i].updates++;
+            return;
+        }
+    }
+    if (_count == TT_FAST_REGIONS_MAX) {
+        Region& last = _regions[_count - 1];
+        join(last.area, area);
+        last.updates++;
+        return;
+    }
+    _regions[_count].area = area;
+    _regions[_count].updates = 1;
+    _count++;
+}
+
+bool TTFastRegions::takeDue(uint32_t inactiveMs, lv_area_t& area) {
+    if (_count == 0) return false;
+    uint8_t most = 0;
+    for (uint8_t i = 1; i < _count; i++) {
+        if (_regions[i].updates > _regions[most].updates) most = i;
+    }
+    if (_regions[most].updates < TT_FAST_REGION_CLEAN_COUNT && inactiveMs < TT_FAST_REGION_CLEAN_IDLE_MS) return false;
+
+    area = _regions[most].area;
+    _regions[most] = _regions[_count - 1];
+    _count--;
+    _cleanups++;
+    return true;
+}
+
+void TTFastRegions::clear() {
+    _count = 0;
+}
+
+void TTFastRegions::report() {
+    printf("Fast regions: %u fast updates, %u region cleanups, %u regions pending\n",
+           (unsigned)_updates, (unsigned)_cleanups, (unsigned)_count);
+}
+
+void TTFastRegions::reset() {
+    _updates = 0;
+    _cleanups = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#define TT_FAST_REGIONS_MAX          8      // Regions tracked at once; a new one beyond that joins the last
+#define TT_FAST_REGION_CLEAN_COUNT   16     // Fast updates a region takes before it is cleaned regardless of input
+#define TT_FAST_REGION_CLEAN_IDLE_MS 5000   // Otherwise clean once input has been idle this long
+
+/**
+ * Areas driven with the fast waveform since they were last cleaned, with the number of fast updates
+ * each took. The short waveform leaves residue that adds up, so TTLvglEpdDriver takes due regions back
+ * out while no frame is pending and cleans them like TTLvglEpdDriver::cleanArea().
+ * Overlapping areas join into one region; a deep refresh or a clean of the ghosted window clears them all.
+ *
+ * UI task only, report() and reset() included (the serial "metrics" command is posted there).
+ */
+class TTFastRegions {
+public:
+    void add(const lv_area_t& area);
+    /** Hands out the most-used region once it took TT_FAST_REGION_CLEAN_COUNT updates or input is idle. */
+    bool takeDue(uint32_t inactiveMs, lv_area_t& area);
+    /** A deep refresh or a clean of every partially refreshed area cleaned everything. */
+    void clear();
+
+    /** Prints fast updates vs. cleanups since reset (serial "metrics" command). */
+    void report();
+    void reset();
+
+private:
+    struct Region {
+        lv_area_t area;
+        uint16_t updates;
+    };
+
+    Region _regions[TT_FAST_REGIONS_MAX];
+    uint8_t _count = 0;
+
+    uint32_t _updates = 0;
+    uint32_t _cleanups = 0;
+};
@@ -1,6 +1,13 @@
+#define TT_LOG_MODULE FONT
+
 #include "TTFontLoader.h"
 #include "Base/Logger.h"
 
+// lv_font_glyph_dsc_t::gid.index: the letter plus where its glyph comes from
+#define TT_FONT_GID_ASCII     0x80000000
+#define TT_FONT_GID_EMBEDDED  0x40000000
+#define TT_FONT_GID_LETTER    0x3FFFFFFF
+
 bool TTFontLoader::_seekToTable(FontData& fd, const char* tag) {
     fd.file.seek(0);
     while (fd.file.available() >= 8) {
@@ -125,7 +132,19 @@ bool TTFontLoader::begin(const char* path, const char* asciiPath) {
     return true;
 }
 
+void TTFontLoader::setEmbedded(const TTEmbeddedFont* embedded) {
+    _embedded = nullptr;
+    if (!embedded) return;
+    if (embedded->ascent != _main.head.ascent || embedded->descent != _main.head.descent) {
+        LOG_W("Embedded %dpx glyphs do not match the font file, re-run tools/embed_fonts.py", embedded->size);
+        return;
+    }
+    _embedded = embedded;
+    LOG_I("Embedded glyphs: %u", (unsigned)embedded->count);
+}
+
 void TTFontLoader::end() {
+    _embedded = nullptr;
     _glyphCacheClear();
     _freeFontData(_ascii);
     _freeFontData(_main);
@@ -294,7 +313,21 @@ bool TTFontLoader::lvglGetGlyphDsc(const lv_font_t* font, lv_font_glyph_dsc_t* d
     
     TTFontLoader* loader = (TTFontLoader*)font->dsc;
     if (!loader) return false;
-    
+
+    const TTEmbeddedGlyph* glyph = loader->_embedded ? loader->_embedded->find(letter) : nullptr;
+    if (glyph) {
+        dsc->box_w = glyph->box_w;
+        dsc->box_h = glyph->box_h;
+        dsc->ofs_y = glyph->ofs_y;
+        dsc->adv_w = glyph->adv_w;
+        dsc->ofs_x = glyph->ofs_x;
+        dsc->format = LV_FONT_GLYPH_FORMAT_A8;
+        dsc->is_placeholder = 0;
+        dsc->resolved_font = font;
+        dsc->gid.index = letter | TT_FONT_GID_EMBEDDED;
+        return true;
+    }
+
     GlyphInfo info;
     if (!loader->getGlyphInfo(letter, info)) {
         return false;
@@ -310,7 +343,7 @@ bool TTFontLoader::lvglGetGlyphDsc(const lv_font_t* font, lv_font_glyph_dsc_t* d
     dsc->is_placeholder = 0;
     dsc->resolved_font = font;
     // Store fromAsciiFont flag in gid.index high bit
-    dsc->gid.index = letter | (info.fromAsciiFont ? 0x80000000 : 0);
+    dsc->gid.index = letter | (info.fromAsciiFont ? TT_FONT_GID_ASCII : 0);
     
     return true;
 }
@@ -324,7 +357,22 @@ const void* TTFontLoader::lvglGetGlyphBitmap(lv_font_glyph_dsc_t* dsc, lv_draw_b
     TTFontLoader* loader = (TTFontLoader*)dsc->resolved_font->dsc;
     if (!loader) return nullptr;
     
-    uint32_t letter = dsc->gid.index & 0x7FFFFFFF;
+    uint32_t letter = dsc->gid.index & TT_FONT_GID_LETTER;
+    if (dsc->gid.index & TT_FONT_GID_EMBEDDED) {
+        const TTEmbeddedGlyph* glyph = loader->_embedded ? loader->_embedded->find(letter) : nullptr;
+        if (!glyph) return nullptr;
+        // Drawn in place from rodata
+        memset(&loader->_drawBuf, 0, sizeof(loader->_drawBuf));
+        loader->_drawBuf.header.magic = LV_IMAGE_HEADER_MAGIC;
+        loader->_drawBuf.header.cf = LV_COLOR_FORMAT_A8;
+        loader->_drawBuf.header.w = glyph->box_w;
+        loader->_drawBuf.header.h = glyph->box_h;
+        loader->_drawBuf.header.stride = glyph->box_w;
+        loader->_drawBuf.data_size = (uint32_t)glyph->box_w * glyph->box_h;
+        loader->_drawBuf.data = const_cast<uint8_t*>(loader->_embedded->bitmaps + glyph->bitmap);
+        return &loader->_drawBuf;
+    }
+
     GlyphInfo info;
     if (!loader->getGlyphInfo(letter, info)) {
         return nullptr;
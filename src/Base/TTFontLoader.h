@@ -5,6 +5,7 @@
 #include <LittleFS.h>
 #include <Adafruit_GFX.h>
 #include <lvgl.h>
+#include "TTEmbeddedFont.h"
 
 // Maximum glyph bitmap size for A8 format (48x48 = 2304 bytes)
 #define TT_FONT_GLYPH_BUF_SIZE 2304
@@ -29,6 +30,10 @@ public:
     // LVGL font interface
     lv_font_t* getLvglFont() { return &_lvFont; }
 
+    // Codepoints in embedded are served from flash rodata, the rest from the file(s).
+    // Call after begin(); ignored if its metrics do not match the main font.
+    void setEmbedded(const TTEmbeddedFont* embedded);
+
     // Glyph info for LVGL
     struct GlyphInfo {
         uint16_t adv_w;
@@ -93,6 +98,7 @@ private:
     FontData _main;     // Main font (Chinese)
     FontData _ascii;    // ASCII font (English)
     uint16_t _color = 0;
+    const TTEmbeddedFont* _embedded = nullptr;
 
     std::map<uint32_t, GlyphInfo> _glyphCache;
     void _glyphCacheClear();
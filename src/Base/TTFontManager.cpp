@@ -1,3 +1,5 @@
+#define TT_LOG_MODULE FONT
+
 #include "TTFontManager.h"
 #include "Logger.h"
 
@@ -20,6 +22,7 @@ bool TTFontManager::begin() {
         std::unique_ptr<TTFontLoader> loader(new TTFontLoader());
         if (loader->begin(path)) {
             LOG_I("Font %d loaded", size);
+            loader->setEmbedded(TTEmbeddedFont_find(size));
             _fonts[size] = std::move(loader);
         } else {
             LOG_W("Failed to load font %d", size);
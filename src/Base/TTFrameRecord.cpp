@@ -0,0 +1,78 @@
+#include "TTFrameRecord.h"
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <stddef.h>
+
+#define TT_FRAME_RECORD_MAGIC  (0x54460000u ^ ((uint32_t)EPD_WIDTH << 12) ^ (uint32_t)EPD_HEIGHT)
+
+struct TTFrameRecordData {
+    uint32_t magic;
+    uint32_t hash;
+    uint8_t partials;
+    uint8_t reserved[3];
+    uint32_t crc;           // Over the fields above
+};
+
+static RTC_NOINIT_ATTR TTFrameRecordData _rtcRecord;
+
+static uint32_t recordCrc(const TTFrameRecordData& r) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&r, offsetof(TTFrameRecordData, crc));
+}
+
+// Spreads one tile's hash over 32 bits, keyed by its position, so the frame hash is an XOR of the tiles
+static uint32_t tileMix(uint32_t index, uint16_t tile) {
+    if (tile == 0) return 0;
+    uint32_t h = (index << 16) | tile;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+bool TTFrameRecord::restore() {
+    _restored = _rtcRecord.magic == TT_FRAME_RECORD_MAGIC && _rtcRecord.crc == recordCrc(_rtcRecord);
+    if (_restored) {
+        _restoredHash = _rtcRecord.hash;
+        _restoredPartials = _rtcRecord.partials;
+    }
+    return _restored;
+}
+
+void TTFrameRecord::addArea(const lv_area_t& area, const uint8_t* pixels) {
+    int32_t stride = (area.x2 - area.x1 + 1 + 7) / 8;
+    int32_t tx1 = area.x1 / TT_FRAME_TILE;
+    int32_t tx2 = area.x2 / TT_FRAME_TILE;
+    for (int32_t ty = area.y1 / TT_FRAME_TILE; ty <= area.y2 / TT_FRAME_TILE; ty++) {
+        int32_t y1 = ty * TT_FRAME_TILE;
+        int32_t y2 = y1 + TT_FRAME_TILE - 1;
+        if (y2 > area.y2) y2 = area.y2;
+        for (int32_t tx = tx1; tx <= tx2; tx++) {
+            // A tile is one byte wide: FNV-1a over its rows, folded to 16 bits, never 0
+            const uint8_t* p = pixels + (y1 - area.y1) * stride + (tx - tx1);
+            uint32_t h = 2166136261u;
+            for (int32_t y = y1; y <= y2; y++, p += stride) {
+                h = (h ^ *p) * 16777619u;
+            }
+            uint16_t tile = (uint16_t)(h ^ (h >> 16));
+            if (tile == 0) tile = 1;
+            uint32_t index = (uint32_t)(ty * TT_FRAME_TILES_X + tx);
+            _hash ^= tileMix(index, _tiles[index]) ^ tileMix(index, tile);
+            _tiles[index] = tile;
+        }
+    }
+}
+
+void TTFrameRecord::store(uint32_t hash, uint8_t partials) {
+    TTFrameRecordData r = {};
+    r.magic = TT_FRAME_RECORD_MAGIC;
+    r.hash = hash;
+    r.partials = partials;
+    r.crc = recordCrc(r);
+    _rtcRecord = r;
+}
+
+void TTFrameRecord::invalidate() {
+    _rtcRecord.magic = 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+#include <EPDConfig.h>
+#include <lvgl.h>
+
+/** Areas are hashed in tiles of 8x8 pixels; the invalidate callback aligns every rendered area to them. */
+#define TT_FRAME_TILE  8
+#define TT_FRAME_TILES_X  ((EPD_WIDTH + TT_FRAME_TILE - 1) / TT_FRAME_TILE)
+#define TT_FRAME_TILES_Y  ((EPD_HEIGHT + TT_FRAME_TILE - 1) / TT_FRAME_TILE)
+
+/**
+ * What the glass shows, kept across restarts. Every flushed area updates a 16-bit hash per tile, and
+ * the frame hash is folded from the tile hashes, so a partial flush updates it without the rest of the
+ * frame. The panel side stores the hash and the partial refreshes since the last deep refresh in RTC
+ * memory once a waveform has run. That memory survives reboots, crashes and OTA restarts but not power
+ * loss; a missing or corrupt record reads as no record.
+ *
+ * addArea() and hash() on the UI task; restore() before the panel starts; store() / invalidate() on the panel side.
+ */
+class TTFrameRecord {
+public:
+    /** Reads the record the previous boot left; false when there is none. */
+    bool restore();
+    bool restored() const { return _restored; }
+    uint32_t restoredHash() const { return _restoredHash; }
+    uint8_t restoredPartials() const { return _restoredPartials; }
+
+    /** A flushed area of I1 rows; x1 / y1 on tile boundaries, x2 / y2 on tile ends or the screen edge. */
+    void addArea(const lv_area_t& area, const uint8_t* pixels);
+    uint32_t hash() const { return _hash; }
+
+    /** The glass now shows the frame with this hash, partials partial refreshes after the last deep one. */
+    void store(uint32_t hash, uint8_t partials);
+    /** The glass shows something no hash describes (a clean pass in progress, a dropped frame). */
+    void invalidate();
+
+private:
+    uint16_t _tiles[TT_FRAME_TILES_X * TT_FRAME_TILES_Y] = {};   // 0: never rendered
+    uint32_t _hash = 0;
+    bool _restored = false;
+    uint32_t _restoredHash = 0;
+    uint8_t _restoredPartials = 0;
+};
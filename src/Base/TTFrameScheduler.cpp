@@ -0,0 +1,57 @@
+#include "TTFrameScheduler.h"
+#include <stdio.h>
+
+void TTFrameScheduler::_open(uint32_t nowMs) {
+    if (_pending) return;
+    _pending = true;
+    _deadlineMs = nowMs + TT_FRAME_DEADLINE_MS;
+}
+
+void TTFrameScheduler::request(TTRefreshLevel level, bool urgent) {
+    _open(millis());
+    if (!_hasLevel || level > _level) _level = level;
+    _hasLevel = true;
+    _urgent = _urgent || urgent;
+    _requests++;
+}
+
+void TTFrameScheduler::addDirty(const lv_area_t& area) {
+    _open(millis());
+    if (!_hasDirty) {
+        _dirty = area;
+        _hasDirty = true;
+    } else {
+        if (area.x1 < _dirty.x1) _dirty.x1 = area.x1;
+        if (area.y1 < _dirty.y1) _dirty.y1 = area.y1;
+        if (area.x2 > _dirty.x2) _dirty.x2 = area.x2;
+        if (area.y2 > _dirty.y2) _dirty.y2 = area.y2;
+    }
+    _invalidations++;
+}
+
+bool TTFrameScheduler::due(uint32_t nowMs) const {
+    return _pending && (_urgent || (int32_t)(nowMs - _deadlineMs) >= 0);
+}
+
+void TTFrameScheduler::take(TTRefreshLevel& level, lv_area_t& dirty, bool& hasDirty) {
+    level = _hasLevel ? _level : TT_REFRESH_PARTIAL;
+    dirty = _dirty;
+    hasDirty = _hasDirty;
+    _pending = false;
+    _urgent = false;
+    _hasDirty = false;
+    _hasLevel = false;
+    _level = TT_REFRESH_PARTIAL;
+    _frames++;
+}
+
+void TTFrameScheduler::report() {
+    printf("Frames: %u committed from %u refresh requests and %u invalidations\n",
+           (unsigned)_frames, (unsigned)_requests, (unsigned)_invalidations);
+}
+
+void TTFrameScheduler::reset() {
+    _requests = 0;
+    _invalidations = 0;
+    _frames = 0;
+}
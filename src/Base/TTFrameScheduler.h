@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include "TTRefreshLevel.h"
+
+/** Longest a non-urgent refresh request waits for others to join it. 0: commit at the end of the same UI loop. */
+#define TT_FRAME_DEADLINE_MS  200
+
+/**
+ * Coalesces refresh requests into frames. TTLvglEpdDriver::requestRefresh() only records the strongest
+ * level asked for; LV_EVENT_INVALIDATE_AREA adds to the dirty region. TTUITask commits at the end of its
+ * loop, and the frame goes out once it is due: TT_FRAME_DEADLINE_MS after the first request, or in the
+ * same loop when a request was urgent (key feedback). Invalidation without a request becomes a partial
+ * frame in the same way; TT_REFRESH_FAST only wins when nothing stronger was asked for.
+ *
+ * UI task only, report() and reset() included (the serial "metrics" command is posted there).
+ */
+class TTFrameScheduler {
+public:
+    void request(TTRefreshLevel level, bool urgent);
+    void addDirty(const lv_area_t& area);
+
+    /** True when a frame is pending and its deadline has passed (or it is urgent). */
+    bool due(uint32_t nowMs) const;
+    bool pending() const { return _pending; }
+    /** Hands out the pending frame and starts a new one. */
+    void take(TTRefreshLevel& level, lv_area_t& dirty, bool& hasDirty);
+
+    /** Prints requests vs. committed frames since reset (serial "metrics" command). */
+    void report();
+    void reset();
+
+private:
+    void _open(uint32_t nowMs);
+
+    bool _pending = false;
+    bool _urgent = false;
+    bool _hasDirty = false;
+    bool _hasLevel = false;
+    TTRefreshLevel _level = TT_REFRESH_PARTIAL;
+    lv_area_t _dirty = {};
+    uint32_t _deadlineMs = 0;
+
+    uint32_t _requests = 0;
+    uint32_t _invalidations = 0;
+    uint32_t _frames = 0;
+};
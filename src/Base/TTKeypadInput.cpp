@@ -1,7 +1,29 @@
+#define TT_LOG_MODULE KEYPAD
+
 #include "TTKeypadInput.h"
 #include "ITTNavigationController.h"
+#include "TTVTask.h"
+#include "TTInstance.h"
+#include "TTLvglEpdDriver.h"
 #include "Logger.h"
-#include <OneButton.h>
+#include <Arduino.h>
+#include <esp_timer.h>
+
+static const uint8_t TT_KEYPAD_PINS[TT_KEYPAD_BUTTON_COUNT] = { PIN_BUTTONL, PIN_BUTTONR, PIN_BUTTONC };
+static const uint32_t TT_KEYPAD_CLICK_KEYS[TT_KEYPAD_BUTTON_COUNT] = { LV_KEY_PREV, LV_KEY_NEXT, LV_KEY_ENTER };
+#define TT_KEYPAD_INDEX_L  0
+
+void IRAM_ATTR TTKeypadInput::_onEdgeISR(void* arg) {
+    Button* btn = static_cast<Button*>(arg);
+    TTKeypadEdge edge;
+    edge.button = btn->index;
+    edge.level = (uint8_t)digitalRead(btn->pin);
+    edge.timeUs = (uint32_t)esp_timer_get_time();
+    btn->owner->_edges.push(edge);
+    if (btn->owner->_wakeTask != nullptr) {
+        btn->owner->_wakeTask->wakeFromISR();
+    }
+}
 
 void TTKeypadInput::keypadReadCb(lv_indev_t* indev, lv_indev_data_t* data) {
     TTKeypadInput* self = (TTKeypadInput*)lv_indev_get_user_data(indev);
@@ -10,67 +32,115 @@ void TTKeypadInput::keypadReadCb(lv_indev_t* indev, lv_indev_data_t* data) {
         data->key = 0;
         return;
     }
-    static uint32_t lastKey = 0;
-    if (self->_pendingKey != 0 && self->_pendingPress) {
+    if (self->_pendingPress) {
+        // Report the press, then ask LVGL to read again right away for the matching release.
         data->key = self->_pendingKey;
         data->state = LV_INDEV_STATE_PRESSED;
-        lastKey = self->_pendingKey;
+        data->continue_reading = true;
+        self->_lastKey = self->_pendingKey;
         self->_pendingPress = false;
     } else {
-        data->key = lastKey;
+        data->key = self->_lastKey;
         data->state = LV_INDEV_STATE_RELEASED;
-        if (self->_pendingKey != 0) {
-            self->_pendingKey = 0;
-        }
+        self->_pendingKey = 0;
     }
 }
 
 void TTKeypadInput::emitKey(uint32_t key) {
+    _dispatchKey(key, micros());
+}
+
+void TTKeypadInput::_dispatchKey(uint32_t key, uint32_t edgeUs) {
     _pendingKey = key;
     _pendingPress = true;
+    if (_indev == nullptr) return;
+    lv_indev_read(_indev);
+    // Key feedback goes out at the end of this UI loop instead of waiting out the frame deadline. Prev / next
+    // only move focus (underlines, cursors), so they ask for the fast waveform; anything stronger requested
+    // by the key's handler (dialog, page push) wins.
+    TTRefreshLevel level = (key == LV_KEY_PREV || key == LV_KEY_NEXT) ? TT_REFRESH_FAST : TT_REFRESH_PARTIAL;
+    TTInstanceOf<TTLvglEpdDriver>().requestRefresh(level, true);
+    LOG_I("Keypad: key %u handled, edge-to-focus latency %u us", (unsigned)key, (unsigned)(micros() - edgeUs));
 }
 
-bool TTKeypadInput::begin(lv_display_t* display) {
+bool TTKeypadInput::begin(lv_display_t* display, TTVTask* wakeTask) {
     /* PCB: BUTTON1/2/3 have 100kΩ pull-down to GND, C has 10kΩ pull-up to 3V3.
      * When pressed, button connects C (HIGH) to BUTTON pin, so BUTTON goes HIGH.
      * So idle = LOW (100kΩ pull-down), pressed = HIGH (active-high).
      * GPIO 34/35/39 have no internal pull-up, use INPUT and rely on circuit. */
-    pinMode(PIN_BUTTONL, INPUT);
-    pinMode(PIN_BUTTONR, INPUT);
-    pinMode(PIN_BUTTONC, INPUT);
-
-    _btnL = new OneButton(PIN_BUTTONL, false, false);
-    _btnR = new OneButton(PIN_BUTTONR, false, false);
-    _btnC = new OneButton(PIN_BUTTONC, false, false);
-
-    _btnL->attachClick([](void* param) { static_cast<TTKeypadInput*>(param)->emitKey(LV_KEY_PREV); }, this);
-    _btnL->attachLongPressStart([](void* param) {
-        TTKeypadInput* self = static_cast<TTKeypadInput*>(param);
-        if (self->_nav != nullptr) {
-            self->_nav->pop();
-        }
-    }, this);
-    _btnR->attachClick([](void* param) { static_cast<TTKeypadInput*>(param)->emitKey(LV_KEY_NEXT); }, this);
-    _btnC->attachClick([](void* param) { static_cast<TTKeypadInput*>(param)->emitKey(LV_KEY_ENTER); }, this);
-
-    delay(50);
-    _btnL->reset();
-    _btnR->reset();
-    _btnC->reset();
+    _wakeTask = wakeTask;
 
     _indev = lv_indev_create();
     lv_indev_set_type(_indev, LV_INDEV_TYPE_KEYPAD);
     lv_indev_set_read_cb(_indev, keypadReadCb);
     lv_indev_set_user_data(_indev, this);
     lv_indev_set_display(_indev, display);
-    lv_indev_set_mode(_indev, LV_INDEV_MODE_TIMER);
+    lv_indev_set_mode(_indev, LV_INDEV_MODE_EVENT);
 
-    LOG_I("Keypad input: L=%d R=%d C=%d (indev TIMER mode)", PIN_BUTTONL, PIN_BUTTONR, PIN_BUTTONC);
+    uint32_t nowUs = micros();
+    for (uint8_t i = 0; i < TT_KEYPAD_BUTTON_COUNT; i++) {
+        Button& btn = _buttons[i];
+        btn.owner = this;
+        btn.index = i;
+        btn.pin = TT_KEYPAD_PINS[i];
+        pinMode(btn.pin, INPUT);
+        btn.pressed = digitalRead(btn.pin) == HIGH;
+        btn.longFired = btn.pressed;  // A button held during boot must not fire on release
+        btn.lastChangeUs = nowUs;
+        attachInterruptArg(digitalPinToInterrupt(btn.pin), _onEdgeISR, &btn, CHANGE);
+    }
+
+    LOG_I("Keypad input: L=%d R=%d C=%d (GPIO interrupts, indev EVENT mode)", PIN_BUTTONL, PIN_BUTTONR, PIN_BUTTONC);
     return true;
 }
 
+void TTKeypadInput::_onEdge(Button& btn, bool level, uint32_t timeUs) {
+    if (level == btn.pressed) return;
+    if ((timeUs - btn.lastChangeUs) < TT_KEYPAD_DEBOUNCE_MS * 1000UL) return;
+
+    btn.pressed = level;
+    btn.lastChangeUs = timeUs;
+    if (level) {
+        btn.pressStartUs = timeUs;
+        btn.longFired = false;
+    } else if (!btn.longFired) {
+        _onClick(btn, timeUs);
+    }
+}
+
+void TTKeypadInput::_onClick(Button& btn, uint32_t edgeUs) {
+    _dispatchKey(TT_KEYPAD_CLICK_KEYS[btn.index], edgeUs);
+}
+
+void TTKeypadInput::_onLongPress(Button& btn) {
+    if (btn.index == TT_KEYPAD_INDEX_L && _nav != nullptr) {
+        LOG_I("Keypad: long press L detected %u us past threshold",
+              (unsigned)(micros() - btn.pressStartUs - TT_KEYPAD_LONG_PRESS_MS * 1000UL));
+        _nav->pop();
+    }
+}
+
 void TTKeypadInput::tick() {
-    if (_btnL) _btnL->tick();
-    if (_btnR) _btnR->tick();
-    if (_btnC) _btnC->tick();
+    TTKeypadEdge edge;
+    while (_edges.pop(edge)) {
+        _onEdge(_buttons[edge.button], edge.level != 0, edge.timeUs);
+    }
+    uint32_t dropped = _edges.takeDropped();
+    if (dropped > 0) {
+        LOG_W("Keypad: %u edges dropped (ring full)", (unsigned)dropped);
+    }
+
+    uint32_t nowUs = micros();
+    for (uint8_t i = 0; i < TT_KEYPAD_BUTTON_COUNT; i++) {
+        Button& btn = _buttons[i];
+        // A bounce that settles inside the debounce window leaves no later edge; resync from the pin.
+        bool level = digitalRead(btn.pin) == HIGH;
+        if (level != btn.pressed) {
+            _onEdge(btn, level, nowUs);
+        }
+        if (btn.pressed && !btn.longFired && (nowUs - btn.pressStartUs) >= TT_KEYPAD_LONG_PRESS_MS * 1000UL) {
+            btn.longFired = true;
+            _onLongPress(btn);
+        }
+    }
 }
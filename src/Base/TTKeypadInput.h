@@ -1,20 +1,39 @@
 #pragma once
 
 #include <lvgl.h>
+#include "TTSpscRing.h"
 
 /* Three-button dial: Left, Right, Center (down). Active high (100kΩ pull-down to GND, pressed connects to C which is HIGH); GPIO 34/35/39 are input-only on ESP32. */
 #define PIN_BUTTONL 35
 #define PIN_BUTTONR 39
 #define PIN_BUTTONC 34
 
-class OneButton;
+#define TT_KEYPAD_BUTTON_COUNT     3
+#define TT_KEYPAD_DEBOUNCE_MS      30
+#define TT_KEYPAD_LONG_PRESS_MS    800
+#define TT_KEYPAD_EDGE_RING_SIZE   32
+
 class ITTNavigationController;
+class TTVTask;
+
+/** One GPIO edge captured in the ISR: button index, pin level after the edge, timestamp in microseconds. */
+struct TTKeypadEdge {
+    uint8_t button;
+    uint8_t level;
+    uint32_t timeUs;
+};
 
+/**
+ * Interrupt-driven keypad. GPIO edge ISRs timestamp every transition into a lock-free ring and wake
+ * the owning task; tick() debounces and classifies click / long press from those timestamps, so the
+ * task can sleep between events without missing presses. Keys are fed to an LVGL keypad indev in
+ * EVENT mode via lv_indev_read().
+ */
 class TTKeypadInput {
 public:
     TTKeypadInput() = default;
 
-    bool begin(lv_display_t* display);
+    bool begin(lv_display_t* display, TTVTask* wakeTask = nullptr);
     void tick();
 
     lv_indev_t* getIndev() const { return _indev; }
@@ -23,13 +42,30 @@ public:
     void setNavigationController(ITTNavigationController* nav) { _nav = nav; }
 
 private:
+    struct Button {
+        TTKeypadInput* owner = nullptr;
+        uint8_t index = 0;
+        uint8_t pin = 0;
+        bool pressed = false;
+        bool longFired = false;
+        uint32_t lastChangeUs = 0;
+        uint32_t pressStartUs = 0;
+    };
+
     static void keypadReadCb(lv_indev_t* indev, lv_indev_data_t* data);
+    static void _onEdgeISR(void* arg);
+
+    void _onEdge(Button& btn, bool level, uint32_t timeUs);
+    void _onClick(Button& btn, uint32_t edgeUs);
+    void _onLongPress(Button& btn);
+    void _dispatchKey(uint32_t key, uint32_t edgeUs);
 
-    OneButton* _btnL = nullptr;
-    OneButton* _btnR = nullptr;
-    OneButton* _btnC = nullptr;
+    Button _buttons[TT_KEYPAD_BUTTON_COUNT];
+    TTSpscRing<TTKeypadEdge, TT_KEYPAD_EDGE_RING_SIZE> _edges;
+    TTVTask* _wakeTask = nullptr;
     lv_indev_t* _indev = nullptr;
-    volatile uint32_t _pendingKey = 0;
-    volatile bool _pendingPress = false;
+    uint32_t _pendingKey = 0;
+    uint32_t _lastKey = 0;
+    bool _pendingPress = false;
     ITTNavigationController* _nav = nullptr;
 };
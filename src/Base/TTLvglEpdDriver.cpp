@@ -1,17 +1,43 @@
+#define TT_LOG_MODULE EPD
+
 #include "TTLvglEpdDriver.h"
 #include "TTDrawBufPassthroughDecoder.h"
 #include "TTInstance.h"
 #include "Tasks/TTUITask.h"
+#include "Tasks/TTPanelTask.h"
+#include "TTNotificationPayloads.h"
 #include <EPDConfig.h>
 #include "Logger.h"
+#include <math.h>
 
-// Static draw buffer - must be aligned for LVGL 9.x
-static uint8_t _drawBuf[EPD_BUF_SIZE] __attribute__((aligned(4)));
+// Static draw buffers - must be aligned for LVGL 9.x. The pipeline renders into one while the panel task reads the other.
+// With EPD_BAND_LINES each holds one band, not a frame.
+#if TT_EPD_PIPELINE
+static uint8_t _drawBuf[2][EPD_BUF_SIZE] __attribute__((aligned(4)));
+#else
+static uint8_t _drawBuf[1][EPD_BUF_SIZE] __attribute__((aligned(4)));
+#endif
 
 static uint32_t lvglTickCallback() {
     return millis();
 }
 
+static void _join(lv_area_t& into, const lv_area_t& area) {
+    if (area.x1 < into.x1) into.x1 = area.x1;
+    if (area.y1 < into.y1) into.y1 = area.y1;
+    if (area.x2 > into.x2) into.x2 = area.x2;
+    if (area.y2 > into.y2) into.y2 = area.y2;
+}
+
+bool TTLvglEpdDriver::restoreFrameRecord() {
+    _bootProbe = _record.restore();
+    if (_bootProbe) {
+        LOG_I("E-Paper frame record from last boot: hash %08x, %u partials", (unsigned)_record.restoredHash(),
+              (unsigned)_record.restoredPartials());
+    }
+    return _bootProbe;
+}
+
 bool TTLvglEpdDriver::begin(EPaperDisplay& display) {
     _epd = &display;
 
@@ -33,22 +59,70 @@ bool TTLvglEpdDriver::begin(EPaperDisplay& display) {
     // Set color format to 1-bit (monochrome)
     lv_display_set_color_format(_lvDisplay, LV_COLOR_FORMAT_I1);
     
-    // Set draw buffer - single buffer mode is sufficient for E-Paper
-    lv_display_set_buffers(_lvDisplay, _drawBuf, nullptr, sizeof(_drawBuf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+#if TT_EPD_PIPELINE
+    lv_display_set_buffers(_lvDisplay, _drawBuf[0], _drawBuf[1], EPD_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    // LVGL waits here before flushing another area while the panel task still holds a buffer
+    lv_display_set_flush_wait_cb(_lvDisplay, _flushWaitCallback);
+#else
+    lv_display_set_buffers(_lvDisplay, _drawBuf[0], nullptr, EPD_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#endif
     
     // Set flush callback
     lv_display_set_flush_cb(_lvDisplay, _flushCallback);
     
     // Store 'this' pointer in user data for callback access
     lv_display_set_user_data(_lvDisplay, this);
+
+    // Refresh-path timing: render starts at LV_EVENT_RENDER_START, BUSY time comes from GxEPD2's busy wait
+    lv_display_add_event_cb(_lvDisplay, _renderStartCallback, LV_EVENT_RENDER_START, this);
+    _epd->epd2.setBusyCallback(TTRefreshMetrics::busyCallback, &_metrics);
+    TTInstanceOf<TTNotificationCenter>().setLatestOnly(TT_NOTIFICATION_REFRESH_METRICS);
     
-    // Note: Keep the refresh timer active, but we'll only update when content changes
-    // The timer is needed for lv_refr_now() to work properly
+    // Frames are committed by commitFrame(), never by LVGL's own refresh timer. The timer must stay
+    // (lv_refr_now() runs through it), and lv_inv_area() resumes it if paused, so park it on a period
+    // it never reaches instead.
+    lv_timer_set_period(lv_display_get_refr_timer(_lvDisplay), UINT32_MAX);
+    lv_display_add_event_cb(_lvDisplay, _invalidateCallback, LV_EVENT_INVALIDATE_AREA, this);
+
+#if EPD_HAS_TEMPERATURE_LUT
+    TTInstanceOf<TTNotificationCenter>().subscribe<TTSensorDataPayload>(
+        TT_NOTIFICATION_SENSOR_DATA_UPDATE, this, &TTInstanceOf<TTUITask>(),
+        [this](const TTSensorDataPayload& p) { setPanelTemperature(p.temperature); });
+#endif
     
     LOG_I("LVGL display initialized: %dx%d, 1bpp", EPD_WIDTH, EPD_HEIGHT);
     return true;
 }
 
+void TTLvglEpdDriver::_renderStartCallback(lv_event_t* e) {
+    TTLvglEpdDriver* pThis = (TTLvglEpdDriver*)lv_event_get_user_data(e);
+    pThis->_renderStartUs = micros();
+}
+
+void TTLvglEpdDriver::_flushWaitCallback(lv_display_t* disp) {
+    TTLvglEpdDriver* pThis = (TTLvglEpdDriver*)lv_display_get_user_data(disp);
+    while (!pThis->panelReady()) {
+        delay(1);
+    }
+}
+
+void TTLvglEpdDriver::_invalidateCallback(lv_event_t* e) {
+    TTLvglEpdDriver* pThis = (TTLvglEpdDriver*)lv_event_get_user_data(e);
+    lv_area_t* area = (lv_area_t*)lv_event_get_param(e);
+    if (area == nullptr) return;
+    // Every rendered area covers whole TTFrameRecord tiles, which also puts it on RAM bytes: bands and
+    // clean windows go to the controller as-is
+    area->x1 &= ~(TT_FRAME_TILE - 1);
+    area->y1 &= ~(TT_FRAME_TILE - 1);
+    area->x2 |= TT_FRAME_TILE - 1;
+    area->y2 |= TT_FRAME_TILE - 1;
+    if (area->x2 > EPD_WIDTH - 1) area->x2 = EPD_WIDTH - 1;
+    if (area->y2 > EPD_HEIGHT - 1) area->y2 = EPD_HEIGHT - 1;
+    // Invalidation from commitFrame() itself belongs to the frame being rendered
+    if (pThis->_committing) return;
+    pThis->_frames.addDirty(*area);
+}
+
 void TTLvglEpdDriver::_flushCallback(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
     TTLvglEpdDriver* pThis = (TTLvglEpdDriver*)lv_display_get_user_data(disp);
     if (!pThis || !pThis->_epd) {
@@ -56,39 +130,143 @@ void TTLvglEpdDriver::_flushCallback(lv_display_t* disp, const lv_area_t* area,
         lv_display_flush_ready(disp);
         return;
     }
-    
+
+    TTPanelFrame frame;
     // Skip the 8-byte palette header for monochrome format
-    px_map += 8;
-    
-    int32_t x1 = area->x1;
-    int32_t y1 = area->y1;
-    int32_t x2 = area->x2;
-    int32_t y2 = area->y2;
+    frame.pixels = px_map + 8;
+    frame.area = *area;
+    frame.renderUs = micros() - pThis->_renderStartUs;
+    frame.fast = pThis->_frameFast;
+    frame.invert = pThis->_frameInvert;
+    frame.clean = pThis->_frameClean;
+    if (!frame.invert && !pThis->_bandAgain) pThis->_record.addArea(*area, frame.pixels);
+    if (pThis->_probing) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+    frame.hash = pThis->_record.hash();
+
+    // Waveform choice stays on the UI task, next to commitFrame() which sets the deep-refresh request
+#if EPD_BAND_LINES > 0
+    // commitFrame() chose the waveform for the whole frame; it is counted once, at its last band
+    frame.deep = pThis->_frameDeep;
+    frame.last = lv_display_flush_is_last(disp);
+    frame.again = pThis->_bandAgain;
+    bool counted = frame.last && !frame.again && !frame.clean;
+#else
+    bool isFullArea = (area->x1 == 0 && area->y1 == 0 && area->x2 == EPD_WIDTH - 1 && area->y2 == EPD_HEIGHT - 1);
+    frame.deep = isFullArea && !frame.clean && (pThis->_needDeepRefresh ||
+                 (pThis->_partialCount >= EPD_FULL_REFRESH_INTERVAL));
+    bool counted = !frame.clean;
+#endif
+    if (counted && frame.deep) {
+        pThis->_partialCount = 0;
+        pThis->_needDeepRefresh = false;
+        pThis->_deepRefreshPending = false;
+        pThis->_hasGhostArea = false;
+        pThis->_fastRegions.clear();
+    } else if (counted) {
+        pThis->_partialCount++;
+    }
+    frame.partials = pThis->_partialCount;
+    if (!frame.deep && !frame.again && !frame.clean) {
+        // Where partial waveforms have run since the last deep refresh: the window a clean would need
+        if (!pThis->_hasGhostArea) {
+            pThis->_ghostArea = *area;
+            pThis->_hasGhostArea = true;
+        } else {
+            _join(pThis->_ghostArea, *area);
+        }
+    }
+
+#if TT_EPD_PIPELINE
+    // The panel task releases the buffer (lv_display_flush_ready) once it is converted
+    pThis->_flushPending.store(true, std::memory_order_release);
+    pThis->_mailbox.post(frame);
+    TTInstanceOf<TTPanelTask>().wake();
+#else
+    pThis->_output(frame);
+#endif
+    // The next area of the same refresh renders from here
+    pThis->_renderStartUs = micros();
+
+    if (counted && !frame.deep && pThis->_partialCount >= EPD_FULL_REFRESH_INTERVAL && !pThis->_deepRefreshPending) {
+        // Resolved by _idleClean(): a windowed clean when the ghosting is local, else a deep refresh
+        pThis->_deepRefreshPending = true;
+    }
+}
+
+void TTLvglEpdDriver::servicePanel() {
+    TTPanelFrame frame;
+    while (_mailbox.take(frame)) {
+        _output(frame);
+    }
+    uint32_t replaced = _mailbox.takeReplaced();
+    if (replaced > 0) {
+        LOG_W("Panel: %u frames replaced before output", (unsigned)replaced);
+        _record.invalidate();
+    }
+}
+
+void TTLvglEpdDriver::setPanelTemperature(float celsius) {
+    if (celsius != celsius) return;     // NaN: sensor read failed
+    int32_t c = (int32_t)lroundf(celsius);
+    if (c < -40) c = -40;
+    if (c > 85) c = 85;
+    _panelTempC.store((int8_t)c, std::memory_order_relaxed);
+}
+
+void TTLvglEpdDriver::_applyTemperature() {
+#if EPD_HAS_TEMPERATURE_LUT
+    int8_t c = _panelTempC.load(std::memory_order_relaxed);
+    if (c == _appliedTempC) return;
+    _appliedTempC = c;
+    // Takes effect with the next waveform; the controller reloads its LUT when the band changes
+    _epd->epd2.setTemperature(c);
+    LOG_I("E-Paper waveform temperature %d C", (int)c);
+#endif
+}
+
+void TTLvglEpdDriver::_output(const TTPanelFrame& frame) {
+    _applyTemperature();
+#if EPD_BAND_LINES > 0
+    return _outputBand(frame);
+#endif
+#if EPD_HAS_WINDOW_CLEAN
+    if (frame.clean) return _outputClean(frame);
+#endif
+    _metrics.beginFlush(frame.renderUs);
+
+    int32_t x1 = frame.area.x1;
+    int32_t y1 = frame.area.y1;
+    int32_t x2 = frame.area.x2;
+    int32_t y2 = frame.area.y2;
     int32_t w = x2 - x1 + 1;
     int32_t h = y2 - y1 + 1;
 
-    LOG_I("Flush area: (%d,%d)-(%d,%d), size %dx%d", x1, y1, x2, y2, w, h);
+    LOG_D("Flush area: (%d,%d)-(%d,%d), size %dx%d", x1, y1, x2, y2, w, h);
 
-    pThis->_epd->setRotation(EPD_ROTATION);
+    _epd->setRotation(EPD_ROTATION);
 
     bool isFullArea = (x1 == 0 && y1 == 0 && x2 == EPD_WIDTH - 1 && y2 == EPD_HEIGHT - 1);
-    bool doFullRefresh = isFullArea && (pThis->_needDeepRefresh ||
-                         (pThis->_partialCount >= EPD_FULL_REFRESH_INTERVAL));
-    if (doFullRefresh) {        
-        pThis->_epd->setFullWindow();
-        pThis->_partialCount = 0;
-        pThis->_needDeepRefresh = false;
-        pThis->_deepRefreshPending = false;
+    if (frame.deep) {
+        _epd->setFullWindow();
         LOG_I("E-Paper full refresh");
-    } else {        
-        pThis->_epd->setPartialWindow(x1, y1, (uint16_t)w, (uint16_t)h);
-        pThis->_partialCount++;
-        LOG_I("E-Paper partial refresh at (%d,%d) %dx%d, partial count: %d", x1, y1, w, h, pThis->_partialCount);
+    } else {
+        _epd->setPartialWindow(x1, y1, (uint16_t)w, (uint16_t)h);
+        LOG_I("E-Paper partial refresh at (%d,%d) %dx%d", x1, y1, w, h);
     }
 
+#if EPD_HAS_FAST_WAVEFORM
+    _epd->epd2.selectFastPartialUpdate(frame.fast);
+#endif
+
     int32_t buf_stride = (w + 7) / 8;
+    // With a single page the GxEPD2 buffer holds the whole window after conversion, so LVGL gets its buffer back early
+    bool released = false;
 
-    pThis->_epd->firstPage();
+    bool morePages;
+    _epd->firstPage();
     do {
         for (int32_t y = y1; y <= y2; y++) {
             for (int32_t x = x1; x <= x2; x++) {
@@ -96,34 +274,197 @@ void TTLvglEpdDriver::_flushCallback(lv_display_t* disp, const lv_area_t* area,
                 int32_t rel_y = y - y1;
                 int32_t byte_idx = rel_y * buf_stride + (rel_x / 8);
                 int32_t bit_idx = 7 - (rel_x % 8);
-                bool isSet = (px_map[byte_idx] >> bit_idx) & 0x01;
+                bool isSet = ((frame.pixels[byte_idx] >> bit_idx) & 0x01) != frame.invert;
                 uint16_t color = isSet ? GxEPD_WHITE : GxEPD_BLACK;
-                pThis->_epd->drawPixel(x, y, color);
+                _epd->drawPixel(x, y, color);
             }
         }
-    } while (pThis->_epd->nextPage());
+        _metrics.endPhase(TT_REFRESH_PHASE_CONVERT);
+        if (!released && _epd->pages() == 1) {
+            _release();
+            released = true;
+        }
+        morePages = _epd->nextPage();   // SPI transfer + waveform (BUSY)
+        _metrics.endPhase(TT_REFRESH_PHASE_TRANSFER);
+    } while (morePages);
+    if (!released) _release();
 
-    LOG_I("E-Paper flush complete");
+    TTRefreshLevel level = frame.deep ? TT_REFRESH_DEEP : frame.fast ? TT_REFRESH_FAST :
+                           (isFullArea ? TT_REFRESH_FULL : TT_REFRESH_PARTIAL);
+    _metrics.finish(level, (int16_t)x1, (int16_t)y1, (uint16_t)w, (uint16_t)h);
+    const TTRefreshMetricsPayload& m = _metrics.last();
+    LOG_I("E-Paper flush complete (%s): render %u, convert %u, transfer %u, busy %u, total %u ms",
+          TTRefreshMetrics::levelName(level),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_RENDER] / 1000), (unsigned)(m.phaseUs[TT_REFRESH_PHASE_CONVERT] / 1000),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TRANSFER] / 1000), (unsigned)(m.phaseUs[TT_REFRESH_PHASE_BUSY] / 1000),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TOTAL] / 1000));
+    _recordFrame(frame);
+}
 
-    lv_display_flush_ready(disp);
+void TTLvglEpdDriver::_outputBand(const TTPanelFrame& frame) {
+    if (!_bandStarted) {
+        _metrics.beginFlush(frame.renderUs);
+        _bandWindow = frame.area;
+        _bandStarted = true;
+    } else {
+        _metrics.addRender(frame.renderUs);
+        _join(_bandWindow, frame.area);
+    }
 
-    if (!doFullRefresh && pThis->_partialCount >= EPD_FULL_REFRESH_INTERVAL && !pThis->_deepRefreshPending) {
-        pThis->_deepRefreshPending = true;
-        TTInstanceOf<TTUITask>().requestDeepRefreshAsync();
+    // I1 rows of a byte-aligned area are already controller RAM format (1 = white): no conversion, no page buffer
+    int16_t x = (int16_t)frame.area.x1;
+    int16_t y = (int16_t)frame.area.y1;
+    int16_t w = (int16_t)(frame.area.x2 - frame.area.x1 + 1);
+    int16_t h = (int16_t)(frame.area.y2 - frame.area.y1 + 1);
+    if (frame.again) {
+        _epd->epd2.writeImageAgain(frame.pixels, x, y, w, h, frame.invert);
+    } else if (frame.deep) {
+        _epd->epd2.writeImageForFullRefresh(frame.pixels, x, y, w, h);
+#if EPD_HAS_WINDOW_CLEAN
+    } else if (frame.clean) {
+        // Previous-image RAM inverse, new-image RAM normal: every pixel of the window changes
+        _epd->epd2.writeImageAgain(frame.pixels, x, y, w, h, true);
+        _epd->epd2.writeImage(frame.pixels, x, y, w, h);
+#endif
+    } else {
+        _epd->epd2.writeImage(frame.pixels, x, y, w, h, frame.invert);
     }
+    _metrics.endPhase(TT_REFRESH_PHASE_TRANSFER);
+    _release();
+    if (!frame.last) return;
+
+    int16_t wx = (int16_t)_bandWindow.x1;
+    int16_t wy = (int16_t)_bandWindow.y1;
+    uint16_t ww = (uint16_t)(_bandWindow.x2 - _bandWindow.x1 + 1);
+    uint16_t wh = (uint16_t)(_bandWindow.y2 - _bandWindow.y1 + 1);
+    if (!frame.again) {
+        if (frame.deep) {
+            LOG_I("E-Paper full refresh");
+            _epd->epd2.refresh(false);
+#if EPD_HAS_WINDOW_CLEAN
+        } else if (frame.clean) {
+            LOG_I("E-Paper clean refresh at (%d,%d) %dx%d", wx, wy, ww, wh);
+            _epd->epd2.refreshClean(wx, wy, (int16_t)ww, (int16_t)wh);
+#endif
+        } else {
+            LOG_I("E-Paper %s refresh at (%d,%d) %dx%d", frame.fast ? "fast" : "partial", wx, wy, ww, wh);
+#if EPD_HAS_FAST_WAVEFORM
+            _epd->epd2.selectFastPartialUpdate(frame.fast);
+#endif
+            _epd->epd2.refresh(wx, wy, (int16_t)ww, (int16_t)wh);
+        }
+        _metrics.endPhase(TT_REFRESH_PHASE_TRANSFER);
+        _recordFrame(frame);
+        // A partial frame's sample also covers its again pass
+        if (!frame.deep) return;
+    }
+    _bandStarted = false;
+
+    bool isFullArea = (ww == EPD_WIDTH && wh == EPD_HEIGHT);
+    // A windowed clean is recorded as a deep refresh of its window
+    TTRefreshLevel level = (frame.deep || (frame.clean && !frame.invert && EPD_HAS_WINDOW_CLEAN)) ? TT_REFRESH_DEEP :
+                           frame.fast ? TT_REFRESH_FAST :
+                           (isFullArea ? TT_REFRESH_FULL : TT_REFRESH_PARTIAL);
+    _metrics.finish(level, wx, wy, ww, wh);
+    const TTRefreshMetricsPayload& m = _metrics.last();
+    LOG_I("E-Paper banded flush complete (%s): render %u, transfer %u, busy %u, total %u ms",
+          TTRefreshMetrics::levelName(level),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_RENDER] / 1000), (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TRANSFER] / 1000),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_BUSY] / 1000), (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TOTAL] / 1000));
+}
+
+#if EPD_HAS_WINDOW_CLEAN
+void TTLvglEpdDriver::_outputClean(const TTPanelFrame& frame) {
+    _metrics.beginFlush(frame.renderUs);
+    int16_t x = (int16_t)frame.area.x1;
+    int16_t y = (int16_t)frame.area.y1;
+    int16_t w = (int16_t)(frame.area.x2 - frame.area.x1 + 1);
+    int16_t h = (int16_t)(frame.area.y2 - frame.area.y1 + 1);
+    LOG_I("E-Paper clean refresh at (%d,%d) %dx%d", x, y, w, h);
+
+    // Byte-aligned I1 rows are controller RAM format. Previous-image RAM inverse, new-image RAM normal:
+    // every pixel of the window changes, so the full-strength LUT drives all of them and nothing outside.
+    _epd->epd2.writeImageAgain(frame.pixels, x, y, w, h, true);
+    _epd->epd2.writeImage(frame.pixels, x, y, w, h);
+    _metrics.endPhase(TT_REFRESH_PHASE_TRANSFER);
+    _epd->epd2.refreshClean(x, y, w, h);
+    // Both RAMs match the glass again for the next partial refresh
+    _epd->epd2.writeImageAgain(frame.pixels, x, y, w, h);
+    _metrics.endPhase(TT_REFRESH_PHASE_TRANSFER);
+    _release();
+
+    _metrics.finish(TT_REFRESH_DEEP, x, y, (uint16_t)w, (uint16_t)h);
+    const TTRefreshMetricsPayload& m = _metrics.last();
+    LOG_I("E-Paper clean complete: transfer %u, busy %u, total %u ms",
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TRANSFER] / 1000), (unsigned)(m.phaseUs[TT_REFRESH_PHASE_BUSY] / 1000),
+          (unsigned)(m.phaseUs[TT_REFRESH_PHASE_TOTAL] / 1000));
+    _recordFrame(frame);
 }
+#endif
 
-void TTLvglEpdDriver::requestRefresh(TTRefreshLevel level) {
+void TTLvglEpdDriver::_recordFrame(const TTPanelFrame& frame) {
+    // Between the two passes of a clean without EPD_HAS_WINDOW_CLEAN the glass shows the inverse
+    if (frame.invert) _record.invalidate();
+    else _record.store(frame.hash, frame.partials);
+}
+
+void TTLvglEpdDriver::_release() {
+    lv_display_flush_ready(_lvDisplay);
+#if TT_EPD_PIPELINE
+    _flushPending.store(false, std::memory_order_release);
+    // A frame may have been held back in commitFrame() while the panel was busy
+    TTInstanceOf<TTUITask>().wake();
+#endif
+}
+
+void TTLvglEpdDriver::requestRefresh(TTRefreshLevel level, bool urgent) {
+    _frames.request(level, urgent);
+}
+
+void TTLvglEpdDriver::commitFrame() {
+    // While the panel holds a frame, later requests keep coalescing: the panel always gets the latest state
+    if (!panelReady()) return;
+    if (!_frames.due(millis())) {
+        // Nothing else on its way to the panel: spend the quiet time on ghosting
+        if (!_frames.pending()) _idleClean();
+        return;
+    }
+
+    TTRefreshLevel level;
+    lv_area_t dirty;
+    bool hasDirty;
+    _frames.take(level, dirty, hasDirty);
+
+    if (level == TT_REFRESH_FAST) {
+        // The short waveform is for small regions; anything larger, or a panel without it, goes partial
+        if (!EPD_HAS_FAST_WAVEFORM || !hasDirty || lv_area_get_size(&dirty) > TT_EPD_FAST_MAX_PIXELS) {
+            level = TT_REFRESH_PARTIAL;
+        }
+    }
+
+    if (_bootProbe) {
+        _bootProbe = false;
+        // Either way the first frame covers the whole panel: a deep refresh, or a partial one that also
+        // brings the controller RAM, lost in the restart, in step with the glass
+        level = _matchBootFrame() ? TT_REFRESH_FULL : TT_REFRESH_DEEP;
+    }
+
+    _committing = true;
+    _frameFast = level == TT_REFRESH_FAST;
+#if EPD_BAND_LINES > 0
+    _frameDeep = level >= TT_REFRESH_FULL &&
+                 (level == TT_REFRESH_DEEP || _needDeepRefresh || _partialCount >= EPD_FULL_REFRESH_INTERVAL);
+#endif
     switch (level) {
+        case TT_REFRESH_FAST:
         case TT_REFRESH_PARTIAL:
-            // Partial refresh: rely on existing invalidation; LVGL will only redraw dirty areas.
-            lv_refr_now(_lvDisplay);
+            // One bounding area: LVGL joins the dirty areas into it, so scattered changes share one waveform.
+            if (hasDirty) lv_inv_area(_lvDisplay, &dirty);
             break;
 
         case TT_REFRESH_FULL:
             // Full-screen LVGL redraw, but still using E-Paper partial refresh waveform.
             lv_obj_invalidate(lv_scr_act());
-            lv_refr_now(_lvDisplay);
             break;
 
         case TT_REFRESH_DEEP:
@@ -131,7 +472,116 @@ void TTLvglEpdDriver::requestRefresh(TTRefreshLevel level) {
             _needDeepRefresh = true;
             _partialCount = 0;
             lv_obj_invalidate(lv_scr_act());
-            lv_refr_now(_lvDisplay);
             break;
     }
+    lv_refr_now(_lvDisplay);
+
+#if EPD_BAND_LINES > 0
+    if (!_frameDeep && (level >= TT_REFRESH_FULL || hasDirty)) {
+        lv_area_t window = {0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1};
+        if (level < TT_REFRESH_FULL) window = dirty;
+        _sendAgain(window);
+    }
+#endif
+    if (_frameFast) _fastRegions.add(dirty);
+    _frameFast = false;
+    _committing = false;
+}
+
+bool TTLvglEpdDriver::_matchBootFrame() {
+    _committing = true;
+    _probing = true;
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(_lvDisplay);
+    _probing = false;
+    _committing = false;
+    if (_record.hash() != _record.restoredHash()) {
+        LOG_I("E-Paper boot frame %08x differs from the panel: deep refresh", (unsigned)_record.hash());
+        return false;
+    }
+    LOG_I("E-Paper boot frame matches the panel: no deep refresh (%u partials so far)",
+          (unsigned)_record.restoredPartials());
+    _needDeepRefresh = false;
+    _partialCount = _record.restoredPartials();
+    if (_partialCount > 0) {
+        // Where those partials ran is not recorded
+        _ghostArea = {0, 0, EPD_WIDTH - 1, EPD_HEIGHT - 1};
+        _hasGhostArea = true;
+    }
+    return true;
+}
+
+void TTLvglEpdDriver::cleanArea(const lv_area_t& area) {
+    if (!_hasCleanArea) {
+        _cleanArea = area;
+        _hasCleanArea = true;
+    } else {
+        _join(_cleanArea, area);
+    }
+}
+
+void TTLvglEpdDriver::_idleClean() {
+    lv_area_t area;
+    if (_deepRefreshPending) {
+        _deepRefreshPending = false;
+        if (_hasGhostArea && lv_area_get_size(&_ghostArea) <= TT_EPD_CLEAN_MAX_PIXELS) {
+            // The partial refreshes since the last deep one stayed local: clean only that window
+            area = _ghostArea;
+            _hasGhostArea = false;
+            _partialCount = 0;
+            _fastRegions.clear();
+            _runClean(area);
+        } else {
+            requestRefresh(TT_REFRESH_DEEP);
+        }
+    } else if (_hasCleanArea) {
+        area = _cleanArea;
+        _hasCleanArea = false;
+        _runClean(area);
+    } else if (_fastRegions.takeDue(lv_display_get_inactive_time(_lvDisplay), area)) {
+        _runClean(area);
+    }
+}
+
+void TTLvglEpdDriver::_runClean(const lv_area_t& area) {
+    LOG_I("E-Paper cleaning (%d,%d)-(%d,%d)", (int)area.x1, (int)area.y1, (int)area.x2, (int)area.y2);
+    _committing = true;
+    _frameClean = true;
+#if EPD_BAND_LINES > 0
+    _frameDeep = false;
+#endif
+#if EPD_HAS_WINDOW_CLEAN
+    // One full-strength waveform over the window (inverse in the previous-image RAM)
+    lv_inv_area(_lvDisplay, &area);
+    lv_refr_now(_lvDisplay);
+#if EPD_BAND_LINES > 0
+    _sendAgain(area);
+#endif
+#else
+    // The partial waveform only drives pixels that change, so every pixel of the window is flipped to
+    // its inverse and back, each time on the full-length partial waveform.
+    for (int pass = 0; pass < 2; pass++) {
+        _frameInvert = pass == 0;
+        lv_inv_area(_lvDisplay, &area);
+        lv_refr_now(_lvDisplay);
+#if EPD_BAND_LINES > 0
+        _sendAgain(area);
+#endif
+    }
+    _frameInvert = false;
+#endif
+    _frameClean = false;
+    _committing = false;
+}
+
+#if EPD_BAND_LINES > 0
+void TTLvglEpdDriver::_sendAgain(const lv_area_t& window) {
+    // GxEPD2_BW re-writes its buffer after a partial waveform so the controller's previous-image RAM
+    // matches the glass. Without a frame buffer the bands are rendered a second time for that; the
+    // panel takes them after the waveform, so here the UI does wait for it.
+    _bandAgain = true;
+    lv_inv_area(_lvDisplay, &window);
+    lv_refr_now(_lvDisplay);
+    _bandAgain = false;
 }
+#endif
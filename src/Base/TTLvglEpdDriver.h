@@ -2,21 +2,126 @@
 
 #include <EPDConfig.h>
 #include <lvgl.h>
+#include <atomic>
+#include "TTMailbox.h"
 #include "TTRefreshLevel.h"
+#include "TTRefreshMetrics.h"
+#include "TTFrameScheduler.h"
+#include "TTFastRegions.h"
+#include "TTFrameRecord.h"
+
+/**
+ * 1: TTPanelTask on the other core owns SPI and BUSY. The UI task renders into one of two draw buffers
+ * and posts the flushed area; the panel task converts it, releases the buffer and runs the waveform
+ * while the UI keeps going. 0: render, convert, transfer and waveform all run inside the UI flush.
+ */
+#define TT_EPD_PIPELINE  1
+
+/** Largest dirty area a TT_REFRESH_FAST frame may cover; bigger frames fall back to the partial waveform. */
+#define TT_EPD_FAST_MAX_PIXELS  (160 * 64)
+
+/**
+ * Ghosting confined to a window up to this size is cleaned in that window when EPD_FULL_REFRESH_INTERVAL
+ * partial refreshes have run, instead of a deep refresh of the whole panel.
+ */
+#define TT_EPD_CLEAN_MAX_PIXELS  (EPD_WIDTH * EPD_HEIGHT / 2)
+
+/** No temperature yet: the panel driver's default waveform timing. */
+#define TT_EPD_TEMP_UNKNOWN  (-128)
+
+/** One flushed LVGL area (a band with EPD_BAND_LINES) on its way to the panel. */
+struct TTPanelFrame {
+    const uint8_t* pixels = nullptr;    // I1 rows of area, palette skipped; owned by LVGL until released
+    lv_area_t area = {};
+    bool deep = false;                  // Full waveform over the whole panel
+    bool fast = false;                  // Short black/white waveform (TT_REFRESH_FAST)
+    bool clean = false;                 // Part of a clean of its window (cleanArea())
+    bool invert = false;                // Written inverted: first pass of a clean without EPD_HAS_WINDOW_CLEAN
+    bool last = true;                   // Last band of the frame: the waveform runs after it
+    bool again = false;                 // Band re-sent after the waveform to sync the controller's previous-image RAM
+    uint32_t renderUs = 0;
+    uint32_t hash = 0;                  // TTFrameRecord hash of the frame once this area is on the glass
+    uint8_t partials = 0;               // Partial refreshes since the last deep one, this area included
+};
 
 class TTLvglEpdDriver {
 public:
 
+    /**
+     * Call before the panel's init(): true when the previous boot left a record of the frame on the glass.
+     * The first frame is then rendered once to compare; a match replaces the boot deep refresh with a
+     * full-screen partial one, so pass !restoreFrameRecord() as init()'s initial flag.
+     */
+    bool restoreFrameRecord();
     bool begin(EPaperDisplay& display);
-    void requestRefresh(TTRefreshLevel level = TT_REFRESH_PARTIAL);
+    /** Records a refresh for the next frame; urgent frames (key feedback) skip the coalescing deadline. */
+    void requestRefresh(TTRefreshLevel level = TT_REFRESH_PARTIAL, bool urgent = false);
+    /** Renders and flushes the pending frame once it is due; called by TTUITask at the end of each loop. */
+    void commitFrame();
     lv_display_t* getDisplay() { return _lvDisplay; }
+    TTRefreshMetrics& metrics() { return _metrics; }
+    TTFrameScheduler& frames() { return _frames; }
+    TTFastRegions& fastRegions() { return _fastRegions; }
+    /**
+     * Queues a clean of area: with EPD_HAS_WINDOW_CLEAN one full-strength waveform over that window only,
+     * else the window is flipped to its inverse and back on the partial waveform. Runs from commitFrame()
+     * once no frame is pending; areas queued meanwhile are joined.
+     */
+    void cleanArea(const lv_area_t& area);
+    /** Ambient temperature from TTSensorTask; the panel picks its waveform timing from it (EPD_HAS_TEMPERATURE_LUT). */
+    void setPanelTemperature(float celsius);
+
+    /** Panel task body: drives every posted frame to the panel, then powers it off when idle (TT_EPD_PIPELINE). */
+    void servicePanel();
+    /** True when a new frame can be rendered without waiting for the panel. */
+    bool panelReady() const { return !_flushPending.load(std::memory_order_acquire); }
 
 private:
     static void _flushCallback(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
+    static void _renderStartCallback(lv_event_t* e);
+    static void _invalidateCallback(lv_event_t* e);
+    static void _flushWaitCallback(lv_display_t* disp);
+    void _output(const TTPanelFrame& frame);
+    void _outputBand(const TTPanelFrame& frame);
+    void _release();
+    void _idleClean();
+    void _runClean(const lv_area_t& area);
+#if EPD_HAS_WINDOW_CLEAN
+    void _outputClean(const TTPanelFrame& frame);
+#endif
+    void _applyTemperature();
+    bool _matchBootFrame();
+    void _recordFrame(const TTPanelFrame& frame);
+#if EPD_BAND_LINES > 0
+    void _sendAgain(const lv_area_t& window);
+#endif
 
     EPaperDisplay* _epd = nullptr;
     lv_display_t* _lvDisplay = nullptr;
     uint8_t _partialCount = 0;
     bool _needDeepRefresh = true;
-    bool _deepRefreshPending = false;
+    bool _deepRefreshPending = false;   // EPD_FULL_REFRESH_INTERVAL reached; _idleClean() cleans or goes deep
+    bool _committing = false;
+    bool _bootProbe = false;        // First commit compares the boot frame with the record (restoreFrameRecord())
+    bool _probing = false;          // Rendering the boot frame for its hash only: nothing goes to the panel
+    bool _frameFast = false;        // Waveform of the frame being committed is TT_REFRESH_FAST
+    bool _frameClean = false;       // Frame being committed is a clean (_runClean())
+    bool _frameInvert = false;      // Frame being committed is the inverted pass of a clean
+    bool _hasCleanArea = false;
+    lv_area_t _cleanArea = {};      // Queued by cleanArea()
+    bool _hasGhostArea = false;
+    lv_area_t _ghostArea = {};      // Union of partial refreshes since the last deep refresh
+    bool _frameDeep = false;        // Banded: waveform of the frame being committed
+    bool _bandAgain = false;        // Banded: commitFrame() is re-sending the frame
+    bool _bandStarted = false;      // Banded, panel side: a frame's bands are arriving
+    lv_area_t _bandWindow = {};     // Banded, panel side: union of the frame's bands
+    uint32_t _renderStartUs = 0;
+    std::atomic<bool> _flushPending{false};   // LVGL buffer handed to the panel and not yet released
+    std::atomic<int8_t> _panelTempC{TT_EPD_TEMP_UNKNOWN};   // Set on the UI task, applied by the panel side
+    int8_t _appliedTempC = TT_EPD_TEMP_UNKNOWN;
+    TTMailbox<TTPanelFrame> _mailbox;
+    TTRefreshMetrics _metrics;
+    TTFrameScheduler _frames;
+    TTFastRegions _fastRegions;
+    TTFrameRecord _record;
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free single-slot mailbox for one producer and one consumer: latest value wins. post() never
+ * blocks; an unread value is replaced (and counted). Three slots rotate between producer, consumer
+ * and the shared middle, so neither side ever copies into a slot the other one is reading.
+ */
+template<typename T>
+class TTMailbox {
+public:
+    void post(const T& item) {
+        _slots[_back] = item;
+        uint8_t prev = _middle.exchange((uint8_t)(_back | FRESH), std::memory_order_acq_rel);
+        if (prev & FRESH) _replaced.fetch_add(1, std::memory_order_relaxed);
+        _back = prev & INDEX;
+    }
+
+    bool take(T& out) {
+        if (!(_middle.load(std::memory_order_acquire) & FRESH)) return false;
+        uint8_t prev = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = prev & INDEX;
+        out = _slots[_front];
+        return true;
+    }
+
+    bool empty() const { return !(_middle.load(std::memory_order_acquire) & FRESH); }
+
+    /** Returns the number of values replaced unread since the last call, and resets the counter. */
+    uint32_t takeReplaced() { return _replaced.exchange(0, std::memory_order_relaxed); }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T _slots[3];
+    uint8_t _back = 0;                      // Producer only
+    uint8_t _front = 1;                     // Consumer only
+    std::atomic<uint8_t> _middle{2};
+    std::atomic<uint32_t> _replaced{0};
+};
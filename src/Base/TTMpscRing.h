@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free bounded multi-producer / single-consumer ring (per-cell sequence numbers).
+ * Any task on either core may push(); exactly one task may pop(). N must be a power of two.
+ * push() fails and counts a drop when the ring is full.
+ */
+template<typename T, uint32_t N>
+class TTMpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "TTMpscRing: N must be a power of two");
+
+public:
+    TTMpscRing() {
+        for (uint32_t i = 0; i < N; i++) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& item) {
+        uint32_t pos = _head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & (N - 1)];
+            uint32_t seq = cell.seq.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& out) {
+        Cell& cell = _cells[_tail & (N - 1)];
+        uint32_t seq = cell.seq.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (_tail + 1)) < 0) return false;
+        out = cell.item;
+        cell.seq.store(_tail + N, std::memory_order_release);
+        _tail++;
+        return true;
+    }
+
+    /** Returns the number of pushes rejected since the last call, and resets the counter. */
+    uint32_t takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+
+    Cell _cells[N];
+    std::atomic<uint32_t> _head{0};
+    uint32_t _tail = 0;
+    std::atomic<uint32_t> _dropped{0};
+};
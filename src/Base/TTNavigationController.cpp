@@ -1,42 +1,64 @@
+#define TT_LOG_MODULE UI
+
 #include "TTNavigationController.h"
+#include <Arduino.h>
 #include "TTScreenPage.h"
 #include "TTKeypadInput.h"
 #include "Logger.h"
 #include "TTInstance.h"
 #include "TTLvglEpdDriver.h"
 #include "TTPopupLayer.h"
+#include <string.h>
+
+static size_t lvglUsedBytes() {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+}
 
 void TTNavigationController::setRoot(std::unique_ptr<ITTScreenPage> page) {
-    for (auto& p : _stack) {
-        p->willDisappear();
-        p->willDestroy();
+    for (auto& e : _stack) {
+        e.page->willDisappear();
+        e.page->willDestroy();
     }
     _stack.clear();
     if (!page) return;
-    page->createScreen();
-    _stack.push_back(std::move(page));
-    _stack.back()->setNavigationController(this);
-    _stack.back()->willAppear();
-    loadScreen(_stack.back().get());
-    requestRefresh(_stack.back().get(), TT_REFRESH_FULL);
+    Entry entry;
+    if (_takeCached(page->getName(), entry)) {
+        entry.page->willResume();
+    } else {
+        entry.bytes = _build(page.get());
+        entry.page = std::move(page);
+    }
+    _stack.push_back(std::move(entry));
+    _stack.back().page->setNavigationController(this);
+    _stack.back().page->willAppear();
+    loadScreen(_stack.back().page.get());
+    requestRefresh(_stack.back().page.get(), TT_REFRESH_FULL);
 }
 
 void TTNavigationController::push(std::unique_ptr<ITTScreenPage> page) {
     if (!page) return;
-    ITTScreenPage* raw = page.get();
-    
-    TTInstanceOf<TTPopupLayer>().showLoading();
-    raw->createScreen();
-    TTInstanceOf<TTPopupLayer>().dismissLoading();
-    
+    Entry entry;
+    if (_takeCached(page->getName(), entry)) {
+        LOG_I("Nav: %s from cache", entry.page->getName());
+        entry.page->willResume();
+    } else {
+        TTInstanceOf<TTPopupLayer>().showLoading();
+        entry.bytes = _build(page.get());
+        TTInstanceOf<TTPopupLayer>().dismissLoading();
+        entry.page = std::move(page);
+    }
+    ITTScreenPage* raw = entry.page.get();
+
     if (!_stack.empty()) {
-        _stack.back()->willDisappear();
+        _stack.back().page->willDisappear();
     }
     raw->willAppear();
     loadScreen(raw);
-    _stack.push_back(std::move(page));
-    _stack.back()->setNavigationController(this);
-    requestRefresh(_stack.back().get(), TT_REFRESH_FULL);
+    _stack.push_back(std::move(entry));
+    raw->setNavigationController(this);
+    requestRefresh(raw, TT_REFRESH_FULL);
 }
 
 void TTNavigationController::pop() {
@@ -44,17 +66,42 @@ void TTNavigationController::pop() {
         LOG_W("Nav: pop ignored (stack size %u)", (unsigned)_stack.size());
         return;
     }
-    _stack.back()->willDisappear();
-    ITTScreenPage* prev = _stack[_stack.size() - 2].get();
+    _stack.back().page->willDisappear();
+    ITTScreenPage* prev = _stack[_stack.size() - 2].page.get();
     prev->willAppear();
     loadScreen(prev);
-    _stack.back()->willDestroy();
+    _park(_stack.back());
     _stack.pop_back();
-    requestRefresh(_stack.back().get(), TT_REFRESH_FULL);
+    requestRefresh(_stack.back().page.get(), TT_REFRESH_FULL);
+}
+
+void TTNavigationController::prebuild(std::unique_ptr<ITTScreenPage> page) {
+    if (!page || TT_NAV_CACHE_BUDGET_BYTES == 0) return;
+    if (isKnown(page->getName()) || _prebuildQueue.size() >= TT_NAV_PREBUILD_MAX) return;
+    _prebuildQueue.push_back(std::move(page));
+}
+
+void TTNavigationController::idle() {
+    if (_prebuildQueue.empty()) return;
+    if (lv_display_get_inactive_time(NULL) < TT_NAV_PREBUILD_IDLE_MS) return;
+
+    Entry entry;
+    entry.page = std::move(_prebuildQueue.front());
+    _prebuildQueue.erase(_prebuildQueue.begin());
+    for (auto& e : _stack) {
+        if (strcmp(e.page->getName(), entry.page->getName()) == 0) return;  // Pushed meanwhile
+    }
+
+    uint32_t startMs = millis();
+    entry.bytes = _build(entry.page.get());
+    entry.page->setNavigationController(this);
+    LOG_I("Nav: pre-built %s (%u bytes, %u ms)", entry.page->getName(), (unsigned)entry.bytes,
+          (unsigned)(millis() - startMs));
+    _park(entry);
 }
 
 ITTScreenPage* TTNavigationController::getCurrentPage() {
-    return _stack.empty() ? nullptr : _stack.back().get();
+    return _stack.empty() ? nullptr : _stack.back().page.get();
 }
 
 void TTNavigationController::loadScreen(ITTScreenPage* page) {
@@ -64,6 +111,74 @@ void TTNavigationController::loadScreen(ITTScreenPage* page) {
     }
 }
 
+size_t TTNavigationController::_build(ITTScreenPage* page) {
+    size_t before = lvglUsedBytes();
+    page->createScreen();
+    size_t after = lvglUsedBytes();
+    return after > before ? after - before : 0;
+}
+
+bool TTNavigationController::_takeCached(const char* name, Entry& out) {
+    for (size_t i = 0; i < _prebuildQueue.size(); i++) {
+        if (strcmp(_prebuildQueue[i]->getName(), name) == 0) {
+            _prebuildQueue.erase(_prebuildQueue.begin() + (int)i);
+            break;
+        }
+    }
+    for (size_t i = 0; i < _cache.size(); i++) {
+        if (strcmp(_cache[i].page->getName(), name) == 0) {
+            out = std::move(_cache[i]);
+            _cache.erase(_cache.begin() + (int)i);
+            _cacheBytes -= out.bytes;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TTNavigationController::_park(Entry& entry) {
+    if (TT_NAV_CACHE_BUDGET_BYTES == 0 || !entry.page->isCacheable() || entry.bytes > TT_NAV_CACHE_BUDGET_BYTES) {
+        _destroy(entry);
+        return;
+    }
+    entry.page->willSuspend();
+    entry.lastUsedMs = millis();
+    _evict(TT_NAV_CACHE_BUDGET_BYTES - entry.bytes);
+    _cacheBytes += entry.bytes;
+    _cache.push_back(std::move(entry));
+}
+
+void TTNavigationController::_evict(size_t budget) {
+    while (_cacheBytes > budget && !_cache.empty()) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < _cache.size(); i++) {
+            if ((int32_t)(_cache[i].lastUsedMs - _cache[oldest].lastUsedMs) < 0) oldest = i;
+        }
+        LOG_I("Nav: evicting %s (%u bytes)", _cache[oldest].page->getName(), (unsigned)_cache[oldest].bytes);
+        _cacheBytes -= _cache[oldest].bytes;
+        _destroy(_cache[oldest]);
+        _cache.erase(_cache.begin() + (int)oldest);
+    }
+}
+
+void TTNavigationController::_destroy(Entry& entry) {
+    entry.page->willDestroy();
+    entry.page.reset();
+}
+
+bool TTNavigationController::isKnown(const char* name) const {
+    for (auto& e : _stack) {
+        if (strcmp(e.page->getName(), name) == 0) return true;
+    }
+    for (auto& e : _cache) {
+        if (strcmp(e.page->getName(), name) == 0) return true;
+    }
+    for (auto& p : _prebuildQueue) {
+        if (strcmp(p->getName(), name) == 0) return true;
+    }
+    return false;
+}
+
 void TTNavigationController::requestRefresh(ITTScreenPage* page, TTRefreshLevel level) {
     if (getCurrentPage() == page) {
         TTInstanceOf<TTLvglEpdDriver>().requestRefresh(level);
@@ -7,14 +7,28 @@
 #include "ITTNavigationController.h"
 #include "ITTScreenPage.h"
 
+/** LVGL pool bytes that popped and pre-built pages may keep alive; 0 disables the page cache. */
+#define TT_NAV_CACHE_BUDGET_BYTES  (12 * 1024)
+/** Pre-build hinted pages only after this long without keypad input. */
+#define TT_NAV_PREBUILD_IDLE_MS    1500
+#define TT_NAV_PREBUILD_MAX        4
+
 class TTKeypadInput;
 class TTScreenPage;
 
+/**
+ * Page stack with an optional page cache. A popped page is suspended (willSuspend) and parked instead of
+ * destroyed; pushing a page with the same name takes it back (willResume), so re-entry is a screen load
+ * and one refresh. prebuild() hints are built into the cache by idle(). The cache holds at most
+ * TT_NAV_CACHE_BUDGET_BYTES of LVGL pool, measured around createScreen(); least recently used pages go first.
+ */
 class TTNavigationController : public ITTNavigationController {
 public:
     void setRoot(std::unique_ptr<ITTScreenPage> page) override;
     void push(std::unique_ptr<ITTScreenPage> page) override;
     void pop() override;
+    void prebuild(std::unique_ptr<ITTScreenPage> page) override;
+    bool isKnown(const char* name) const override;
 
     ITTScreenPage* getCurrentPage() override;
     void requestRefresh(ITTScreenPage* page, TTRefreshLevel level = TT_REFRESH_PARTIAL) override;
@@ -24,9 +38,26 @@ public:
     bool canPop() const override { return _stack.size() > 1; }
     size_t stackSize() const override { return _stack.size(); }
 
+    /** Build one hinted page when the UI has been idle; called by TTUITask at the end of each loop. */
+    void idle();
+
 private:
-    void loadScreen(ITTScreenPage* page);
+    struct Entry {
+        std::unique_ptr<ITTScreenPage> page;
+        size_t bytes = 0;           // LVGL pool taken by createScreen()
+        uint32_t lastUsedMs = 0;
+    };
 
-    std::vector<std::unique_ptr<ITTScreenPage>> _stack;
+    void loadScreen(ITTScreenPage* page);
+    size_t _build(ITTScreenPage* page);
+    bool _takeCached(const char* name, Entry& out);
+    void _park(Entry& entry);
+    void _evict(size_t budget);
+    void _destroy(Entry& entry);
+
+    std::vector<Entry> _stack;
+    std::vector<Entry> _cache;
+    std::vector<std::unique_ptr<ITTScreenPage>> _prebuildQueue;
+    size_t _cacheBytes = 0;
     TTKeypadInput* _keypad = nullptr;
 };
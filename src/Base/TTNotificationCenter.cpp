@@ -1,13 +1,197 @@
+#define TT_LOG_MODULE NOTIFY
+
 #include "TTNotificationCenter.h"
+#include "TTVTask.h"
+#include "Logger.h"
+
+TTNotificationCenter::~TTNotificationCenter() {
+    for (size_t c = 0; c < TT_NOTIFICATION_MAX_CHANNELS; c++) {
+        for (size_t r = 0; r < TT_NOTIFICATION_MAX_TASKS; r++) {
+            Route& route = _channels[c].routes[r];
+            for (size_t i = 0; i < route.subs.size(); i++) {
+                route.subs[i].destroy(route.subs[i].callback);
+            }
+        }
+    }
+}
+
+TTNotificationCenter::Envelope* TTNotificationCenter::_acquireEnvelope() {
+    uint32_t start = _poolNext.fetch_add(1, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < TT_NOTIFICATION_POOL_SIZE; i++) {
+        Envelope& env = _pool[(start + i) % TT_NOTIFICATION_POOL_SIZE];
+        if (env.used.load(std::memory_order_relaxed)) continue;
+        bool expected = false;
+        if (env.used.compare_exchange_strong(expected, true, std::memory_order_acquire)) return &env;
+    }
+    _poolDropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+TTNotificationCenter::Channel* TTNotificationCenter::_findChannel(TTNotificationId id, bool create) {
+    uint32_t mask = TT_NOTIFICATION_MAX_CHANNELS - 1;
+    for (uint32_t probe = 0; probe < TT_NOTIFICATION_MAX_CHANNELS; probe++) {
+        Channel& ch = _channels[(id + probe) & mask];
+        TTNotificationId cur = ch.id.load(std::memory_order_acquire);
+        if (cur == id) return &ch;
+        if (cur == 0) {
+            if (!create) return nullptr;
+            if (ch.id.compare_exchange_strong(cur, id, std::memory_order_acq_rel)) return &ch;
+            if (cur == id) return &ch;  // Claimed concurrently for the same id
+        }
+    }
+    return nullptr;
+}
+
+TTNotificationCenter::Inbox* TTNotificationCenter::_findInbox(TTVTask* task, bool create) {
+    for (size_t i = 0; i < TT_NOTIFICATION_MAX_TASKS; i++) {
+        TTVTask* cur = _inboxes[i].task.load(std::memory_order_acquire);
+        if (cur == task) return &_inboxes[i];
+        if (cur == nullptr) {
+            if (!create) return nullptr;
+            if (_inboxes[i].task.compare_exchange_strong(cur, task, std::memory_order_acq_rel)) return &_inboxes[i];
+            if (cur == task) return &_inboxes[i];
+        }
+    }
+    return nullptr;
+}
+
+void TTNotificationCenter::setLatestOnly(TTNotificationId id) {
+    Channel* ch = _findChannel(id, true);
+    if (ch == nullptr) {
+        LOG_E("NotificationCenter: channel table full (max %d), 0x%08x", TT_NOTIFICATION_MAX_CHANNELS, (unsigned)id);
+        return;
+    }
+    ch->latestOnly.store(true, std::memory_order_release);
+}
+
+void TTNotificationCenter::_addSubscription(TTNotificationId id, TTVTask* task, const Subscription& sub) {
+    if (task == nullptr || !task->isCurrentTask()) {
+        LOG_E("NotificationCenter: subscribe to 0x%08x must run on its delivery task", (unsigned)id);
+        sub.destroy(sub.callback);
+        return;
+    }
+    Channel* ch = _findChannel(id, true);
+    if (ch == nullptr || _findInbox(task, true) == nullptr) {
+        LOG_E("NotificationCenter: table full (channels %d, tasks %d), dropping subscription 0x%08x",
+              TT_NOTIFICATION_MAX_CHANNELS, TT_NOTIFICATION_MAX_TASKS, (unsigned)id);
+        sub.destroy(sub.callback);
+        return;
+    }
+
+    Route* route = nullptr;
+    for (size_t r = 0; r < TT_NOTIFICATION_MAX_TASKS && route == nullptr; r++) {
+        TTVTask* cur = ch->routes[r].task.load(std::memory_order_acquire);
+        if (cur == task) {
+            route = &ch->routes[r];
+        } else if (cur == nullptr && ch->routes[r].task.compare_exchange_strong(cur, task, std::memory_order_acq_rel)) {
+            route = &ch->routes[r];
+        }
+    }
+    if (route == nullptr) {
+        LOG_E("NotificationCenter: too many delivery tasks on 0x%08x", (unsigned)id);
+        sub.destroy(sub.callback);
+        return;
+    }
+    route->subs.push_back(sub);
+
+    std::lock_guard<std::mutex> lock(_observerMutex);
+    std::vector<Route*>& routes = _observerRoutes[sub.observer];
+    for (size_t i = 0; i < routes.size(); i++) {
+        if (routes[i] == route) return;
+    }
+    routes.push_back(route);
+}
+
+void TTNotificationCenter::_enqueue(Channel* ch, Route* route, TTVTask* task, Envelope* env) {
+    if (ch->latestOnly.load(std::memory_order_acquire)) {
+        Envelope* old = route->latest.exchange(env, std::memory_order_acq_rel);
+        if (old != nullptr) _releaseEnvelope(old);
+        task->wake();
+        return;
+    }
+    Inbox* inbox = _findInbox(task, false);
+    if (inbox == nullptr || !inbox->queue.push(env)) {
+        _releaseEnvelope(env);
+        return;
+    }
+    task->wake();
+}
+
+void TTNotificationCenter::_dispatch(Envelope* env) {
+    std::vector<Subscription>& subs = env->route->subs;
+    for (size_t i = 0; i < subs.size(); i++) {
+        if (subs[i].parked) continue;
+        if (subs[i].payloadType != env->payloadType) {
+            LOG_E("NotificationCenter: payload type mismatch");
+            continue;
+        }
+        subs[i].invoke(subs[i].callback, env->payload);
+    }
+    _releaseEnvelope(env);
+}
+
+void TTNotificationCenter::deliver(TTVTask* task) {
+    Inbox* inbox = _findInbox(task, false);
+    if (inbox == nullptr) return;
+
+    Envelope* env;
+    while (inbox->queue.pop(env)) {
+        _dispatch(env);
+    }
+    uint32_t dropped = inbox->queue.takeDropped();
+    if (dropped > 0) {
+        LOG_W("NotificationCenter: %u notifications dropped (inbox full)", (unsigned)dropped);
+    }
+    dropped = _poolDropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LOG_W("NotificationCenter: %u notifications dropped (envelope pool empty)", (unsigned)dropped);
+    }
+
+    for (size_t c = 0; c < TT_NOTIFICATION_MAX_CHANNELS; c++) {
+        Channel& ch = _channels[c];
+        if (!ch.latestOnly.load(std::memory_order_acquire)) continue;
+        for (size_t r = 0; r < TT_NOTIFICATION_MAX_TASKS; r++) {
+            if (ch.routes[r].task.load(std::memory_order_acquire) != task) continue;
+            env = ch.routes[r].latest.exchange(nullptr, std::memory_order_acq_rel);
+            if (env != nullptr) _dispatch(env);
+        }
+    }
+}
 
 void TTNotificationCenter::unsubscribeByObserver(void* observer) {
-    for (std::map<std::string, std::vector<std::pair<void*, Handler>>>::iterator it = _handlers.begin();
-         it != _handlers.end(); ++it) {
-        std::vector<std::pair<void*, Handler>>& vec = it->second;
+    std::vector<Route*> routes;
+    {
+        std::lock_guard<std::mutex> lock(_observerMutex);
+        std::unordered_map<void*, std::vector<Route*>>::iterator it = _observerRoutes.find(observer);
+        if (it == _observerRoutes.end()) return;
+        routes.swap(it->second);
+        _observerRoutes.erase(it);
+    }
+
+    for (size_t r = 0; r < routes.size(); r++) {
+        std::vector<Subscription>& vec = routes[r]->subs;
         for (size_t i = vec.size(); i > 0; i--) {
-            if (vec[i - 1].first == observer) {
+            if (vec[i - 1].observer == observer) {
+                vec[i - 1].destroy(vec[i - 1].callback);
                 vec.erase(vec.begin() + (int)(i - 1));
             }
         }
     }
 }
+
+void TTNotificationCenter::setObserverParked(void* observer, bool parked) {
+    std::vector<Route*> routes;
+    {
+        std::lock_guard<std::mutex> lock(_observerMutex);
+        std::unordered_map<void*, std::vector<Route*>>::iterator it = _observerRoutes.find(observer);
+        if (it == _observerRoutes.end()) return;
+        routes = it->second;
+    }
+
+    for (size_t r = 0; r < routes.size(); r++) {
+        std::vector<Subscription>& vec = routes[r]->subs;
+        for (size_t i = 0; i < vec.size(); i++) {
+            if (vec[i].observer == observer) vec[i].parked = parked;
+        }
+    }
+}
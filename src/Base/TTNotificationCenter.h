@@ -1,41 +1,171 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
-#include <map>
-#include <string>
-#include <utility>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+#include "TTMpscRing.h"
 
+/** Max number of distinct notification names (open-addressed table size, power of two). */
+#define TT_NOTIFICATION_MAX_CHANNELS  16
+/** Max number of tasks that notifications can be delivered on. */
+#define TT_NOTIFICATION_MAX_TASKS     4
+/** Per-task inbox depth for queued (non-coalesced) notifications, power of two. */
+#define TT_NOTIFICATION_INBOX_SIZE    16
+/** Envelopes shared by all channels and tasks; a post that finds none free is dropped and counted. */
+#define TT_NOTIFICATION_POOL_SIZE     32
+/** Largest payload: payloads are copied into a pooled envelope, so they must also be trivially copyable. */
+#define TT_NOTIFICATION_PAYLOAD_MAX   48
+
+typedef uint32_t TTNotificationId;
+
+/** FNV-1a hash of a notification name; 0 is reserved for empty table slots. */
+constexpr TTNotificationId ttNotificationHash(const char* s, uint32_t h = 2166136261u) {
+    return *s ? ttNotificationHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : (h != 0 ? h : 1);
+}
+
+/** Interns a notification name at compile time. */
+#define TT_NOTIFICATION_ID(name) (std::integral_constant<TTNotificationId, ttNotificationHash(name)>::value)
+
+class TTVTask;
+
+/**
+ * Cross-task publish/subscribe bus. post() may be called from any task on either core and never blocks or
+ * allocates: the payload is copied into an envelope from a fixed pool per target task and pushed to that
+ * task's lock-free inbox.
+ * Each subscriber names the TTVTask its callback runs on; TTVTask drains its batch once per loop via deliver().
+ * Channels marked with setLatestOnly() keep only the newest undelivered payload per target task.
+ *
+ * subscribe(), unsubscribeByObserver() and setObserverParked() must run on the task given as deliverOn.
+ */
 class TTNotificationCenter {
 public:
+    ~TTNotificationCenter();
+
     template<typename PayloadType>
-    void subscribe(const char* name, void* observer, std::function<void(const PayloadType&)> callback);
+    void subscribe(TTNotificationId id, void* observer, TTVTask* deliverOn, std::function<void(const PayloadType&)> callback);
 
     template<typename PayloadType>
-    void post(const char* name, const PayloadType& payload);
+    void post(TTNotificationId id, const PayloadType& payload);
+
+    /** "Latest value wins": undelivered payloads on this channel are replaced instead of queued. */
+    void setLatestOnly(TTNotificationId id);
 
     void unsubscribeByObserver(void* observer);
 
+    /** Parked subscriptions stay registered but are skipped on delivery (e.g. a cached, suspended page). */
+    void setObserverParked(void* observer, bool parked);
+
+    /** Invoke all pending notifications for task's subscribers. Called from TTVTask's loop. */
+    void deliver(TTVTask* task);
+
 private:
-    typedef std::function<void(const void*)> Handler;
-    std::map<std::string, std::vector<std::pair<void*, Handler>>> _handlers;
+    typedef void (*Invoker)(const void* callback, const void* payload);
+    typedef void (*Deleter)(void* callback);
+
+    struct Subscription {
+        void* observer;
+        const void* payloadType;
+        void* callback;
+        Invoker invoke;
+        Deleter destroy;
+        bool parked;
+    };
+
+    struct Envelope;
+
+    /** Delivery route for one (channel, task) pair. subs is only touched on the owning task. */
+    struct Route {
+        std::atomic<TTVTask*> task{nullptr};
+        std::atomic<Envelope*> latest{nullptr};
+        std::vector<Subscription> subs;
+    };
+
+    struct Channel {
+        std::atomic<TTNotificationId> id{0};
+        std::atomic<bool> latestOnly{false};
+        Route routes[TT_NOTIFICATION_MAX_TASKS];
+    };
+
+    struct Envelope {
+        std::atomic<bool> used{false};
+        Route* route;
+        const void* payloadType;
+        alignas(8) unsigned char payload[TT_NOTIFICATION_PAYLOAD_MAX];
+    };
+
+    struct Inbox {
+        std::atomic<TTVTask*> task{nullptr};
+        TTMpscRing<Envelope*, TT_NOTIFICATION_INBOX_SIZE> queue;
+    };
+
+    template<typename PayloadType>
+    static const void* _payloadTypeTag() {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    template<typename PayloadType>
+    static void _invoke(const void* callback, const void* payload) {
+        (*static_cast<const std::function<void(const PayloadType&)>*>(callback))(*static_cast<const PayloadType*>(payload));
+    }
+
+    template<typename PayloadType>
+    static void _destroy(void* callback) {
+        delete static_cast<std::function<void(const PayloadType&)>*>(callback);
+    }
+
+    Envelope* _acquireEnvelope();
+    static void _releaseEnvelope(Envelope* env) { env->used.store(false, std::memory_order_release); }
+    Channel* _findChannel(TTNotificationId id, bool create);
+    Inbox* _findInbox(TTVTask* task, bool create);
+    void _addSubscription(TTNotificationId id, TTVTask* task, const Subscription& sub);
+    void _enqueue(Channel* ch, Route* route, TTVTask* task, Envelope* env);
+    void _dispatch(Envelope* env);
+
+    Channel _channels[TT_NOTIFICATION_MAX_CHANNELS];
+    Inbox _inboxes[TT_NOTIFICATION_MAX_TASKS];
+    Envelope _pool[TT_NOTIFICATION_POOL_SIZE];
+    std::atomic<uint32_t> _poolNext{0};         // Where the next free-envelope scan starts
+    std::atomic<uint32_t> _poolDropped{0};
+    std::mutex _observerMutex;
+    std::unordered_map<void*, std::vector<Route*>> _observerRoutes;
 };
 
 template<typename PayloadType>
 void TTNotificationCenter::subscribe(
-    const char* name, void* observer, std::function<void(const PayloadType&)> callback) {
-    Handler h = [callback](const void* p) {
-        callback(*static_cast<const PayloadType*>(p));
-    };
-    _handlers[name].push_back(std::make_pair(observer, h));
+    TTNotificationId id, void* observer, TTVTask* deliverOn, std::function<void(const PayloadType&)> callback) {
+    Subscription sub;
+    sub.observer = observer;
+    sub.payloadType = _payloadTypeTag<PayloadType>();
+    sub.callback = new std::function<void(const PayloadType&)>(std::move(callback));
+    sub.invoke = &_invoke<PayloadType>;
+    sub.destroy = &_destroy<PayloadType>;
+    sub.parked = false;
+    _addSubscription(id, deliverOn, sub);
 }
 
 template<typename PayloadType>
-void TTNotificationCenter::post(const char* name, const PayloadType& payload) {
-    std::map<std::string, std::vector<std::pair<void*, Handler>>>::iterator it = _handlers.find(name);
-    if (it == _handlers.end()) return;
-    const void* p = &payload;
-    for (size_t i = 0; i < it->second.size(); i++) {
-        it->second[i].second(p);
+void TTNotificationCenter::post(TTNotificationId id, const PayloadType& payload) {
+    static_assert(sizeof(PayloadType) <= TT_NOTIFICATION_PAYLOAD_MAX, "payload larger than TT_NOTIFICATION_PAYLOAD_MAX");
+    static_assert(alignof(PayloadType) <= 8, "payload alignment above 8");
+    static_assert(std::is_trivially_copyable<PayloadType>::value, "payloads are copied bytewise");
+    Channel* ch = _findChannel(id, false);
+    if (ch == nullptr) return;
+    for (size_t r = 0; r < TT_NOTIFICATION_MAX_TASKS; r++) {
+        Route& route = ch->routes[r];
+        TTVTask* task = route.task.load(std::memory_order_acquire);
+        if (task == nullptr) break;  // Routes are claimed in order
+        Envelope* env = _acquireEnvelope();
+        if (env == nullptr) continue;
+        memcpy(env->payload, &payload, sizeof(PayloadType));
+        env->route = &route;
+        env->payloadType = _payloadTypeTag<PayloadType>();
+        _enqueue(ch, &route, task, env);
     }
 }
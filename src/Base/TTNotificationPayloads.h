@@ -1,9 +1,33 @@
 #pragma once
 
-#define TT_NOTIFICATION_SENSOR_DATA_UPDATE "TTNotify.SensorDataUpdate"
+#include "TTNotificationCenter.h"
+
+#define TT_NOTIFICATION_SENSOR_DATA_UPDATE TT_NOTIFICATION_ID("TTNotify.SensorDataUpdate")
 
 struct TTSensorDataPayload {
     float temperature;
     float humidity;
     float pressure;
 };
+
+#define TT_NOTIFICATION_REFRESH_METRICS TT_NOTIFICATION_ID("TTNotify.RefreshMetrics")
+
+enum TTRefreshPhase {
+    TT_REFRESH_PHASE_RENDER = 0,    // LVGL drawing into the I1 draw buffer
+    TT_REFRESH_PHASE_CONVERT,       // I1 buffer into the GxEPD2 frame buffer
+    TT_REFRESH_PHASE_TRANSFER,      // SPI writes and controller commands
+    TT_REFRESH_PHASE_BUSY,          // Waiting on BUSY while the waveform runs
+    TT_REFRESH_PHASE_TOTAL,
+    TT_REFRESH_PHASE_COUNT
+};
+
+/** One panel flush, posted latest-value-wins after it completes. */
+struct TTRefreshMetricsPayload {
+    uint32_t timeMs;
+    uint32_t phaseUs[TT_REFRESH_PHASE_COUNT];
+    int16_t x;
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint8_t level;                  // TTRefreshLevel actually driven (TT_REFRESH_DEEP: full waveform)
+};
@@ -0,0 +1,246 @@
+#define TT_LOG_MODULE STORAGE
+
+#include "TTNvsPreference.h"
+#include "TTPreference.h"
+#include "TTInstance.h"
+#include "TTVTask.h"
+#include "Logger.h"
+#include "ErrorCheck.h"
+
+template<> struct TTNvsPreference::Traits<int32_t> {
+    static const Type kind = TYPE_INT;
+    static float number(int32_t v) { return (float)v; }
+    static const char* string(int32_t) { return nullptr; }
+};
+
+template<> struct TTNvsPreference::Traits<float> {
+    static const Type kind = TYPE_FLOAT;
+    static float number(float v) { return v; }
+    static const char* string(float) { return nullptr; }
+};
+
+template<> struct TTNvsPreference::Traits<bool> {
+    static const Type kind = TYPE_BOOL;
+    static float number(bool v) { return v ? 1.0f : 0.0f; }
+    static const char* string(bool) { return nullptr; }
+};
+
+template<> struct TTNvsPreference::Traits<String> {
+    static const Type kind = TYPE_STRING;
+    static float number(const char*) { return 0.0f; }
+    static const char* string(const char* v) { return v; }
+};
+
+template<> struct TTNvsPreference::Traits<TTPrefBlob> {
+    static const Type kind = TYPE_BLOB;
+    template<typename D> static float number(D) { return 0.0f; }
+    template<typename D> static const char* string(D) { return nullptr; }
+};
+
+const TTNvsPreference::KeyDesc TTNvsPreference::_keys[TT_PREF_KEY_COUNT] = {
+#define TT_PREF_X_DESC(id, name, type, def) \
+    { name, Traits<type>::kind, Traits<type>::number(def), Traits<type>::string(def) },
+    TT_PREFERENCE_KEYS(TT_PREF_X_DESC)
+#undef TT_PREF_X_DESC
+};
+
+bool TTNvsPreference::begin() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_opened) {
+            _opened = _nvs.begin(TT_NVS_PREFERENCE_NAMESPACE, false);
+        }
+        if (!_opened) {
+            LOG_E("NvsPreference: failed to open namespace %s", TT_NVS_PREFERENCE_NAMESPACE);
+            return false;
+        }
+        if (_nvs.isKey(TT_NVS_PREFERENCE_MIGRATED)) {
+            return true;
+        }
+    }
+    return _migrateFromJson();
+}
+
+bool TTNvsPreference::_migrateFromJson() {
+    TTPreference& json = TTInstanceOf<TTPreference>();
+    if (!json.begin()) {
+        // Not mounted or failed its CRC: every key would read as absent. Leave the flag unset so the
+        // next boot tries again instead of dropping the saved values for good
+        LOG_E("NvsPreference: %s unreadable, migration deferred", DEFAULT_CONFIG_FILE);
+        return false;
+    }
+    uint32_t imported = 0;
+    for (uint8_t i = 0; i < TT_PREF_KEY_COUNT; i++) {
+        const KeyDesc& d = _keys[i];
+        if (d.type == TYPE_BLOB || !json.contains(d.name)) continue;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        CacheEntry& e = _entry((TTPrefIndex)i);
+        bool ok = false;
+        switch (d.type) {
+            case TYPE_INT:    ok = json.get(d.name, e.i, e.i); break;
+            case TYPE_FLOAT:  ok = json.get(d.name, e.f, e.f); break;
+            case TYPE_BOOL:   ok = json.get(d.name, e.b, e.b); break;
+            case TYPE_STRING: ok = json.get(d.name, e.s, e.s); break;
+            default: break;
+        }
+        if (!ok) continue;
+        e.present = true;
+        _markDirty((TTPrefIndex)i);
+        imported++;
+    }
+
+    ERR_CHECK_RET(flush());
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nvs.putBool(TT_NVS_PREFERENCE_MIGRATED, true);
+    LOG_I("NvsPreference: migrated %u key(s) from %s", (unsigned)imported, DEFAULT_CONFIG_FILE);
+    return true;
+}
+
+TTNvsPreference::CacheEntry& TTNvsPreference::_entry(TTPrefIndex index) {
+    CacheEntry& e = _cache[index];
+    if (!e.loaded) {
+        _loadEntry(index, e);
+        e.loaded = true;
+    }
+    return e;
+}
+
+void TTNvsPreference::_applyDefault(TTPrefIndex index, CacheEntry& e) {
+    const KeyDesc& d = _keys[index];
+    e.i = (int32_t)d.defNumber;
+    e.f = d.defNumber;
+    e.b = d.defNumber != 0.0f;
+    e.s = d.defString != nullptr ? d.defString : "";
+}
+
+void TTNvsPreference::_loadEntry(TTPrefIndex index, CacheEntry& e) {
+    const KeyDesc& d = _keys[index];
+    _applyDefault(index, e);
+    if (!_opened) _opened = _nvs.begin(TT_NVS_PREFERENCE_NAMESPACE, false);
+    e.present = _opened && d.type != TYPE_BLOB && _nvs.isKey(d.name);
+    if (!e.present) return;
+
+    switch (d.type) {
+        case TYPE_INT:    e.i = _nvs.getInt(d.name, e.i); break;
+        case TYPE_FLOAT:  e.f = _nvs.getFloat(d.name, e.f); break;
+        case TYPE_BOOL:   e.b = _nvs.getBool(d.name, e.b); break;
+        case TYPE_STRING: e.s = _nvs.getString(d.name, e.s); break;
+        default: break;
+    }
+}
+
+void TTNvsPreference::_markDirty(TTPrefIndex index) {
+    uint32_t now = millis();
+    if (_dirty == 0) _firstDirtyMs = now;
+    _lastChangeMs = now;
+    _dirty |= 1UL << index;
+    if (_writer != nullptr) _writer->wake();
+}
+
+size_t TTNvsPreference::getBlob(TTPrefKey<TTPrefBlob> key, void* buf, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_opened) _opened = _nvs.begin(TT_NVS_PREFERENCE_NAMESPACE, false);
+    const char* name = _keys[key.index].name;
+    if (!_opened || !_nvs.isKey(name)) return 0;
+    return _nvs.getBytes(name, buf, len);
+}
+
+bool TTNvsPreference::setBlob(TTPrefKey<TTPrefBlob> key, const void* data, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_opened) _opened = _nvs.begin(TT_NVS_PREFERENCE_NAMESPACE, false);
+    const char* name = _keys[key.index].name;
+    if (!_opened || _nvs.putBytes(name, data, len) != len) {
+        LOG_E("NvsPreference: failed to write blob %s", name);
+        return false;
+    }
+    return true;
+}
+
+bool TTNvsPreference::sync() {
+    TTVTask* writer;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_dirty == 0) return true;
+        _syncRequested = true;
+        writer = _writer;
+    }
+    if (writer == nullptr) return flush();
+    writer->wake();
+    return true;
+}
+
+bool TTNvsPreference::flush() {
+    std::lock_guard<std::mutex> writeLock(_writeMutex);
+
+    uint32_t dirty;
+    CacheEntry snapshot[TT_PREF_KEY_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_dirty == 0) return true;
+        if (!_opened) {
+            LOG_E("NvsPreference: namespace not open, cannot flush");
+            return false;
+        }
+        dirty = _dirty;
+        _dirty = 0;
+        _syncRequested = false;
+        for (uint8_t i = 0; i < TT_PREF_KEY_COUNT; i++) {
+            if (dirty & (1UL << i)) snapshot[i] = _cache[i];
+        }
+    }
+
+    uint32_t failed = 0;
+    uint32_t written = 0;
+    for (uint8_t i = 0; i < TT_PREF_KEY_COUNT; i++) {
+        if (!(dirty & (1UL << i))) continue;
+        const KeyDesc& d = _keys[i];
+        const CacheEntry& e = snapshot[i];
+        bool ok;
+        if (!e.present) {
+            ok = !_nvs.isKey(d.name) || _nvs.remove(d.name);
+        } else {
+            switch (d.type) {
+                case TYPE_INT:    ok = _nvs.putInt(d.name, e.i) == sizeof(int32_t); break;
+                case TYPE_FLOAT:  ok = _nvs.putFloat(d.name, e.f) == sizeof(float); break;
+                case TYPE_BOOL:   ok = _nvs.putBool(d.name, e.b) == sizeof(uint8_t); break;
+                case TYPE_STRING: ok = _nvs.putString(d.name, e.s) == e.s.length(); break;
+                default:          ok = true; break;
+            }
+        }
+        if (ok) {
+            written++;
+        } else {
+            LOG_E("NvsPreference: failed to write %s", d.name);
+            failed |= 1UL << i;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (failed != 0) {
+        if (_dirty == 0) _firstDirtyMs = millis();
+        _dirty |= failed;
+        _lastChangeMs = millis();
+        return false;
+    }
+    LOG_D("NvsPreference: committed %u key(s)", (unsigned)written);
+    return true;
+}
+
+void TTNvsPreference::attachWriter(TTVTask* writer) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _writer = writer;
+}
+
+void TTNvsPreference::flushIfDue() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_dirty == 0) return;
+        uint32_t now = millis();
+        bool due = _syncRequested ||
+                   (now - _lastChangeMs) >= TT_PREFERENCE_FLUSH_DELAY_MS ||
+                   (now - _firstDirtyMs) >= TT_PREFERENCE_FLUSH_MAX_DELAY_MS;
+        if (!due) return;
+    }
+    flush();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <mutex>
+#include "TTPreferenceKeys.h"
+
+#define TT_NVS_PREFERENCE_NAMESPACE  "tt"
+#define TT_NVS_PREFERENCE_MIGRATED   "_migrated"   // Set once /config.json has been imported
+
+static_assert(TT_PREF_KEY_COUNT <= 32, "TTNvsPreference dirty mask holds 32 keys");
+
+class TTVTask;
+
+/**
+ * Typed settings in the NVS partition, keyed by the compile-time registry in TTPreferenceKeys.h.
+ * Values are read from NVS once on first use and served from a RAM cache afterwards, so boot costs
+ * one NVS read per key actually used. set() updates the cache and marks the key dirty; the writer
+ * task (TTStorageTask) commits dirty keys after TT_PREFERENCE_FLUSH_DELAY_MS, unchanged values are
+ * never rewritten. Blobs are not cached and are read / written through.
+ *
+ * begin() imports registered keys from the legacy JSON /config.json (TTPreference) the first time.
+ * While that file cannot be read, begin() returns false and the import is retried on the next boot.
+ */
+class TTNvsPreference {
+public:
+    bool begin();
+
+    template<typename T>
+    T get(TTPrefKey<T> key);
+
+    template<typename T>
+    bool set(TTPrefKey<T> key, const T& value);
+
+    /** Reset a key to its registered default. */
+    template<typename T>
+    bool remove(TTPrefKey<T> key);
+
+    size_t getBlob(TTPrefKey<TTPrefBlob> key, void* buf, size_t len);
+    bool setBlob(TTPrefKey<TTPrefBlob> key, const void* data, size_t len);
+
+    // Same contract as TTPreference: sync() is asynchronous, flush() writes on the caller
+    bool sync();
+    bool flush();
+
+    void attachWriter(TTVTask* writer);
+    void flushIfDue();
+
+private:
+    enum Type { TYPE_INT, TYPE_FLOAT, TYPE_BOOL, TYPE_STRING, TYPE_BLOB };
+
+    struct KeyDesc {
+        const char* name;
+        Type type;
+        float defNumber;        // int / float / bool default
+        const char* defString;
+    };
+
+    struct CacheEntry {
+        bool loaded = false;
+        bool present = false;   // Stored in NVS (false: default value, remove pending)
+        int32_t i = 0;
+        float f = 0.0f;
+        bool b = false;
+        String s;
+    };
+
+    template<typename T> struct Traits;   // Maps a registry type to Type and its default (see .cpp)
+
+    static const KeyDesc _keys[TT_PREF_KEY_COUNT];
+
+    CacheEntry& _entry(TTPrefIndex index);
+    void _loadEntry(TTPrefIndex index, CacheEntry& e);
+    void _applyDefault(TTPrefIndex index, CacheEntry& e);
+    void _markDirty(TTPrefIndex index);
+    bool _migrateFromJson();
+
+    void _read(CacheEntry& e, int32_t& out) const { out = e.i; }
+    void _read(CacheEntry& e, float& out) const { out = e.f; }
+    void _read(CacheEntry& e, bool& out) const { out = e.b; }
+    void _read(CacheEntry& e, String& out) const { out = e.s; }
+    static bool _write(CacheEntry& e, const int32_t& v) { bool c = e.i != v; e.i = v; return c; }
+    static bool _write(CacheEntry& e, const float& v) { bool c = e.f != v; e.f = v; return c; }
+    static bool _write(CacheEntry& e, const bool& v) { bool c = e.b != v; e.b = v; return c; }
+    static bool _write(CacheEntry& e, const String& v) { bool c = e.s != v; e.s = v; return c; }
+
+    Preferences _nvs;
+    bool _opened = false;
+    CacheEntry _cache[TT_PREF_KEY_COUNT];
+    std::mutex _mutex;
+    std::mutex _writeMutex;
+    TTVTask* _writer = nullptr;
+    uint32_t _dirty = 0;
+    uint32_t _firstDirtyMs = 0;
+    uint32_t _lastChangeMs = 0;
+    bool _syncRequested = false;
+};
+
+template<typename T>
+T TTNvsPreference::get(TTPrefKey<T> key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    T value;
+    _read(_entry(key.index), value);
+    return value;
+}
+
+template<typename T>
+bool TTNvsPreference::set(TTPrefKey<T> key, const T& value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    CacheEntry& e = _entry(key.index);
+    bool changed = _write(e, value);
+    if (!changed && e.present) return true;
+    e.present = true;
+    _markDirty(key.index);
+    return true;
+}
+
+template<typename T>
+bool TTNvsPreference::remove(TTPrefKey<T> key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    CacheEntry& e = _entry(key.index);
+    if (!e.present) return true;
+    e.present = false;
+    _applyDefault(key.index, e);
+    _markDirty(key.index);
+    return true;
+}
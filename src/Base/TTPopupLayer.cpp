@@ -1,3 +1,5 @@
+#define TT_LOG_MODULE UI
+
 #include "TTPopupLayer.h"
 #include "TTKeypadInput.h"
 #include "Logger.h"
@@ -22,7 +24,21 @@ void TTPopupLayer::begin(lv_display_t* display) {
 void TTPopupLayer::showToast(const char* text, uint32_t durationMs) {
     if (_topLayer == nullptr) return;
     dismissToast();
+    _toastWanted = true;
+    _toastChanged = true;
+    _toastText = text != nullptr ? text : "";
+    _toastDurationMs = durationMs;
+}
+
+void TTPopupLayer::dismissToast() {
+    if (_toastTimer != nullptr) {
+        lv_timer_del(_toastTimer);
+        _toastTimer = nullptr;
+    }
+    _toastWanted = false;
+}
 
+void TTPopupLayer::_createToast() {
     _toastPanel = lv_obj_create(_topLayer);
     lv_obj_add_flag(_toastPanel, LV_OBJ_FLAG_IGNORE_LAYOUT);
     lv_obj_set_size(_toastPanel, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
@@ -35,7 +51,7 @@ void TTPopupLayer::showToast(const char* text, uint32_t durationMs) {
     lv_obj_remove_flag(_toastPanel, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t* label = lv_label_create(_toastPanel);
-    lv_label_set_text(label, text != nullptr ? text : "");
+    lv_label_set_text(label, _toastText.c_str());
     lv_obj_set_style_text_color(label, lv_color_black(), 0);
     lv_font_t* font = TTFontManager::instance().getFont(12);
     if (font != nullptr) {
@@ -44,43 +60,33 @@ void TTPopupLayer::showToast(const char* text, uint32_t durationMs) {
 
     lv_obj_update_layout(_toastPanel);
     lv_obj_align(_toastPanel, LV_ALIGN_CENTER, 0, 0);
+    _invalidateOverlay(_toastPanel, _toastBounds);
 
-    TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
-
-    if (durationMs > 0 && _toastTimer == nullptr) {
-        _toastTimer = lv_timer_create(toastTimerCallback, durationMs, this);
+    // The duration counts from when the toast is actually drawn
+    if (_toastDurationMs > 0) {
+        _toastTimer = lv_timer_create(toastTimerCallback, _toastDurationMs, this);
         lv_timer_set_repeat_count(_toastTimer, 1);
     }
 }
 
-void TTPopupLayer::dismissToast() {
-    if (_toastTimer != nullptr) {
-        lv_timer_del(_toastTimer);
-        _toastTimer = nullptr;
-    }
-    if (_toastPanel != nullptr) {
-        lv_obj_delete(_toastPanel);
-        _toastPanel = nullptr;
-        TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
-    }
-}
-
 void TTPopupLayer::toastTimerCallback(lv_timer_t* timer) {
     TTPopupLayer* self = (TTPopupLayer*)lv_timer_get_user_data(timer);
     if (self != nullptr) {
         self->_toastTimer = nullptr;
-        if (self->_toastPanel != nullptr) {
-            lv_obj_delete(self->_toastPanel);
-            self->_toastPanel = nullptr;
-            TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
-        }
+        self->_toastWanted = false;
     }
 }
 
 void TTPopupLayer::showLoading() {
     if (_topLayer == nullptr) return;
-    dismissLoading();
+    _loadingWanted = true;
+}
 
+void TTPopupLayer::dismissLoading() {
+    _loadingWanted = false;
+}
+
+void TTPopupLayer::_createLoading() {
     _loadingPanel = lv_obj_create(_topLayer);
     lv_obj_add_flag(_loadingPanel, LV_OBJ_FLAG_IGNORE_LAYOUT);
     lv_obj_set_size(_loadingPanel, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
@@ -102,16 +108,48 @@ void TTPopupLayer::showLoading() {
 
     lv_obj_update_layout(_loadingPanel);
     lv_obj_align(_loadingPanel, LV_ALIGN_CENTER, 0, 0);
+    _invalidateOverlay(_loadingPanel, _loadingBounds);
+}
 
-    TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
+void TTPopupLayer::_invalidateOverlay(lv_obj_t* panel, lv_area_t& bounds) {
+    lv_obj_update_layout(panel);
+    lv_obj_get_coords(panel, &bounds);
+    _invalidate(bounds);
 }
 
-void TTPopupLayer::dismissLoading() {
-    if (_loadingPanel != nullptr) {
-        lv_obj_delete(_loadingPanel);
-        _loadingPanel = nullptr;
-        TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
+void TTPopupLayer::_deleteOverlay(lv_obj_t*& panel, lv_area_t& bounds) {
+    if (panel == nullptr) return;
+    lv_obj_delete(panel);
+    panel = nullptr;
+    _invalidate(bounds);
+}
+
+void TTPopupLayer::_invalidate(const lv_area_t& area) {
+    lv_inv_area(_display, &area);
+    _refreshPending = true;
+}
+
+void TTPopupLayer::commit() {
+    if (_topLayer == nullptr) return;
+
+    if (_toastPanel != nullptr && (!_toastWanted || _toastChanged)) {
+        _deleteOverlay(_toastPanel, _toastBounds);
     }
+    if (_toastPanel == nullptr && _toastWanted) {
+        _createToast();
+    }
+    _toastChanged = false;
+
+    if (_loadingPanel != nullptr && !_loadingWanted) {
+        _deleteOverlay(_loadingPanel, _loadingBounds);
+    } else if (_loadingPanel == nullptr && _loadingWanted) {
+        _createLoading();
+    }
+
+    if (!_refreshPending) return;
+    _refreshPending = false;
+    // Renders only what is still invalid: nothing if a full-screen refresh already covered it
+    TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_PARTIAL);
 }
 
 void TTPopupLayer::dialogBtnFocusChanged(lv_event_t* e) {
@@ -247,8 +285,7 @@ void TTPopupLayer::showDialog(const char* msg, DialogCallback onOk, DialogCallba
 
     lv_obj_update_layout(_dialogPanel);
     lv_obj_align(_dialogPanel, LV_ALIGN_CENTER, 0, 0);
-
-    TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
+    _invalidateOverlay(_dialogPanel, _dialogBounds);
 }
 
 void TTPopupLayer::dismissDialog() {
@@ -260,9 +297,5 @@ void TTPopupLayer::dismissDialog() {
         lv_group_delete(_dialogGroup);
         _dialogGroup = nullptr;
     }
-    if (_dialogPanel != nullptr) {
-        lv_obj_delete(_dialogPanel);
-        _dialogPanel = nullptr;
-        TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_FULL);
-    }
+    _deleteOverlay(_dialogPanel, _dialogBounds);
 }
@@ -2,6 +2,7 @@
 
 #include <lvgl.h>
 #include <functional>
+#include <string>
 
 #define TT_POPUP_DIALOG_BTN_UNDERLINE_H  1
 #define TT_POPUP_DIALOG_BTN_UNDERLINE_W_CANCEL  42
@@ -13,6 +14,10 @@ class TTKeypadInput;
  * Popup layer that stays on top of all screen pages (LVGL display top layer).
  * Use for toast messages, dialogs, or any overlay that should appear above the nav stack.
  * Dialog takes keypad focus (own group); on show the current page group is saved and restored on dismiss.
+ *
+ * Overlays refresh only their own bounds (and their previous bounds on dismiss) with a partial
+ * update, once per UI loop in commit(). Toast and loading overlay are built in commit() too, so a
+ * show/dismiss pair within one loop (e.g. loading around a fast createScreen()) never reaches the panel.
  */
 class TTPopupLayer {
 public:
@@ -32,7 +37,16 @@ public:
     void showDialog(const char* msg, DialogCallback onOk, DialogCallback onCancel);
     void dismissDialog();
 
+    /** Apply pending overlay changes and refresh their areas; called by TTUITask at the end of each loop. */
+    void commit();
+
 private:
+    void _createToast();
+    void _createLoading();
+    void _deleteOverlay(lv_obj_t*& panel, lv_area_t& bounds);
+    void _invalidateOverlay(lv_obj_t* panel, lv_area_t& bounds);
+    void _invalidate(const lv_area_t& area);
+
     static void toastTimerCallback(lv_timer_t* timer);
     static void dialogBtnClicked(lv_event_t* e);
     static void dialogBtnFocusChanged(lv_event_t* e);
@@ -43,6 +57,19 @@ private:
     lv_timer_t* _toastTimer = nullptr;
     lv_obj_t* _loadingPanel = nullptr;
 
+    // Requested state, applied in commit()
+    bool _toastWanted = false;
+    bool _toastChanged = false;
+    std::string _toastText;
+    uint32_t _toastDurationMs = 0;
+    bool _loadingWanted = false;
+
+    // Last drawn bounds per overlay, refreshed again on dismiss
+    lv_area_t _toastBounds = {};
+    lv_area_t _loadingBounds = {};
+    lv_area_t _dialogBounds = {};
+    bool _refreshPending = false;
+
     TTKeypadInput* _keypad = nullptr;
     lv_obj_t* _dialogPanel = nullptr;
     lv_group_t* _dialogGroup = nullptr;
@@ -1,53 +1,133 @@
+#define TT_LOG_MODULE STORAGE
+
 #include "TTPreference.h"
 #include "ErrorCheck.h"
+#include "TTVTask.h"
 
 bool TTPreference::begin() {
-    _loaded = false;
-    _dirty = false;
-    ERR_CHECK_RET(storage.begin());
-    ERR_CHECK_RET(_load());
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Already loaded (first get / set, or clear()): reloading would drop changes not yet flushed
+    _ensureLoaded();
+    return !_loadFailed;
+}
+
+bool TTPreference::_ensureLoaded() {
+    if (!_loaded) _load();
     return true;
 }
 
-bool TTPreference::_load() {
-    _doc.clear();
-    ERR_CHECK_RET(storage.loadConfig(_doc));
+void TTPreference::_load() {
+    JsonDocument loaded;
+    if (!storage.begin() || !storage.loadConfig(loaded)) {
+        // Latched: defaults from here on instead of retrying flash I/O on every get(); the next
+        // flush replaces the unreadable file
+        LOG_E("Preference: %s unreadable, using defaults", DEFAULT_CONFIG_FILE);
+        loaded.clear();
+        _loadFailed = true;
+    }
+    _doc = loaded;
     _loaded = true;
-    _dirty = false;
-    return true;
 }
 
-bool TTPreference::_save() {
-    if (!_dirty) {
-        return true;
+void TTPreference::_markDirty() {
+    uint32_t now = millis();
+    if (_flushedGeneration == _generation) {
+        _firstDirtyMs = now;
     }
-    
-    ERR_CHECK_RET(storage.saveConfig(_doc));
-    _dirty = false;
-    return true;
+    _lastChangeMs = now;
+    _generation++;
+    if (_writer != nullptr) _writer->wake();
+}
+
+bool TTPreference::contains(const char* key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_ensureLoaded()) return false;
+    return _doc.containsKey(key);
 }
 
 bool TTPreference::remove(const char* key) {
-    if (!_loaded) {
-        ERR_CHECK_RET(_load());
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    ERR_CHECK_RET(_ensureLoaded());
     
     if (!_doc.containsKey(key)) {
         return true;
     }
     
     _doc.remove(key);
-    _dirty = true;
+    _markDirty();
     return true;
 }
 
 bool TTPreference::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
     _doc.clear();
     _loaded = true;
-    _dirty = true;
+    _markDirty();
     return true;
 }
 
 bool TTPreference::sync() {
-    return _save();
+    TTVTask* writer;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_flushedGeneration == _generation) return true;
+        _syncRequested = true;
+        writer = _writer;
+    }
+    if (writer == nullptr) {
+        LOG_W("Preference: no writer task attached, saving on the calling task");
+        return flush();
+    }
+    writer->wake();
+    return true;
+}
+
+bool TTPreference::flush() {
+    std::lock_guard<std::mutex> writeLock(_writeMutex);
+
+    String json;
+    uint32_t generation;
+    {
+        // Snapshot under the lock; the slow LittleFS write happens without blocking get / set
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_flushedGeneration == _generation) return true;
+        generation = _generation;
+        _syncRequested = false;
+        if (serializeJson(_doc, json) == 0) {
+            LOG_E("Preference: failed to serialize config");
+            return false;
+        }
+    }
+
+    bool ok = storage.writeFileAtomic(DEFAULT_CONFIG_FILE, (const uint8_t*)json.c_str(), json.length());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!ok) {
+        // Retry after another debounce window rather than spinning on a failing flash
+        _lastChangeMs = millis();
+        _firstDirtyMs = _lastChangeMs;
+        LOG_E("Preference: failed to save %s", DEFAULT_CONFIG_FILE);
+        return false;
+    }
+    LOG_I("Preference: saved %u change(s) in one write", (unsigned)(generation - _flushedGeneration));
+    _flushedGeneration = generation;
+    return true;
+}
+
+void TTPreference::attachWriter(TTVTask* writer) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _writer = writer;
+}
+
+void TTPreference::flushIfDue() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_flushedGeneration == _generation) return;
+        uint32_t now = millis();
+        bool due = _syncRequested ||
+                   (now - _lastChangeMs) >= TT_PREFERENCE_FLUSH_DELAY_MS ||
+                   (now - _firstDirtyMs) >= TT_PREFERENCE_FLUSH_MAX_DELAY_MS;
+        if (!due) return;
+    }
+    flush();
 }
@@ -3,11 +3,23 @@
 #include "TTStorage.h"
 #include "ErrorCheck.h"
 #include <ArduinoJson.h>
+#include <mutex>
 
 #define CAPACITY 1024 * 4
 
+#define TT_PREFERENCE_FLUSH_DELAY_MS      2000    // Flush once no change happened for this long
+#define TT_PREFERENCE_FLUSH_MAX_DELAY_MS  10000   // ...but at most this long after the first unflushed change
+
+class TTVTask;
+
+/**
+ * Key-value config kept in memory and persisted as JSON. get / set / remove / clear only touch
+ * memory and are safe from any task; changes are coalesced and written by the writer task
+ * (TTStorageTask) after a debounce window, via TTStorage::writeFileAtomic() (temp file, fsync, rename, CRC).
+ */
 class TTPreference {
 public:
+    /** Loads the file if no get / set did yet; false if it was unreadable and defaults are in use. */
     bool begin();
     
     // Get config value, use default value if key doesn't exist
@@ -18,31 +30,49 @@ public:
     template<typename T>
     bool set(const char* key, T value);
     
+    // True if the key exists
+    bool contains(const char* key);
+
     // Remove a config item
     bool remove(const char* key);
     
     // Clear all config items
     bool clear();
     
-    // Save changes to storage if needed
+    // Ask the writer task to save pending changes now, skipping the debounce window; does not block
     bool sync();
 
+    // Save pending changes on the calling task (e.g. right before ESP.restart())
+    bool flush();
+
+    // Writer side: the task that calls flushIfDue(); it is woken on every change
+    void attachWriter(TTVTask* writer);
+    void flushIfDue();
+
 private:
     TTStorage storage;
     JsonDocument _doc;
     bool _loaded = false;
-    bool _dirty = false;
+    bool _loadFailed = false;       // The file could not be read; running on defaults
+    std::mutex _mutex;        // Guards _doc and the dirty state
+    std::mutex _writeMutex;   // Serializes flushes so temp files never interleave
+    TTVTask* _writer = nullptr;
+    uint32_t _generation = 0;
+    uint32_t _flushedGeneration = 0;
+    uint32_t _firstDirtyMs = 0;
+    uint32_t _lastChangeMs = 0;
+    bool _syncRequested = false;
     
-    bool _load();
-    bool _save();
+    void _load();
+    bool _ensureLoaded();
+    void _markDirty();
 };
 
 // Template function implementations
 template<typename T>
 bool TTPreference::get(const char* key, T& outValue, const T& defaultValue) {
-    if (!_loaded) {
-        ERR_CHECK_RET(_load());
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    ERR_CHECK_RET(_ensureLoaded());
     
     if (!_doc.containsKey(key)) {
         outValue = defaultValue;
@@ -55,11 +85,10 @@ bool TTPreference::get(const char* key, T& outValue, const T& defaultValue) {
 
 template<typename T>
 bool TTPreference::set(const char* key, T value) {
-    if (!_loaded) {
-        ERR_CHECK_RET(_load());
-    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    ERR_CHECK_RET(_ensureLoaded());
     
     _doc[key] = value;
-    _dirty = true;
+    _markDirty();
     return true;
 }
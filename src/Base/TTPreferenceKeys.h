@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+
+/** Marker type for raw binary values; the default is always empty. */
+struct TTPrefBlob {};
+
+/*
+ * Compile-time registry of typed settings stored by TTNvsPreference.
+ * X(ID, "nvs_key", type, default)  —  type is int32_t, float, bool, String or TTPrefBlob.
+ * NVS keys are at most 15 characters; the JSON key of the same name is migrated from /config.json.
+ */
+#define TT_PREFERENCE_KEYS(X)                                   \
+    X(WIFI_SSID,      "wifi_ssid",      String,  "")            \
+    X(WIFI_PASSWORD,  "wifi_password",  String,  "")
+
+enum TTPrefIndex {
+#define TT_PREF_X_INDEX(id, name, type, def) TT_PREF_INDEX_##id,
+    TT_PREFERENCE_KEYS(TT_PREF_X_INDEX)
+#undef TT_PREF_X_INDEX
+    TT_PREF_KEY_COUNT
+};
+
+/** Typed handle to a registered key; the value type is checked at compile time. */
+template<typename T>
+struct TTPrefKey {
+    TTPrefIndex index;
+};
+
+#define TT_PREF_X_KEY(id, name, type, def) constexpr TTPrefKey<type> TT_PREF_##id = { TT_PREF_INDEX_##id };
+TT_PREFERENCE_KEYS(TT_PREF_X_KEY)
+#undef TT_PREF_X_KEY
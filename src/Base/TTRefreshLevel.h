@@ -1,7 +1,9 @@
 #pragma once
 
+/** Ordered weakest to strongest: a frame takes the strongest level requested for it. */
 enum TTRefreshLevel {
-    TT_REFRESH_PARTIAL = 0,
+    TT_REFRESH_FAST = 0,    // Short black/white-only waveform for small interactive regions (focus, cursor)
+    TT_REFRESH_PARTIAL,
     TT_REFRESH_FULL,
     TT_REFRESH_DEEP
 };
@@ -0,0 +1,142 @@
+#include "TTRefreshMetrics.h"
+#include "TTInstance.h"
+#include <stdio.h>
+#include <algorithm>
+
+void TTRefreshMetrics::beginFlush(uint32_t renderUs) {
+    _markUs = micros();
+    _flushStartUs = _markUs - renderUs;
+    _busyUs = 0;
+    _busyLastUs = 0;
+    memset(&_current, 0, sizeof(_current));
+    _current.phaseUs[TT_REFRESH_PHASE_RENDER] = renderUs;
+}
+
+void TTRefreshMetrics::endPhase(TTRefreshPhase phase) {
+    uint32_t now = micros();
+    _current.phaseUs[phase] += now - _markUs;
+    _markUs = now;
+}
+
+void TTRefreshMetrics::busyCallback(const void* param) {
+    TTRefreshMetrics* self = (TTRefreshMetrics*)param;
+    uint32_t now = micros();
+    if (self->_busyLastUs != 0 && now - self->_busyLastUs < TT_REFRESH_METRICS_BUSY_GAP_US) {
+        self->_busyUs += now - self->_busyLastUs;
+    }
+    self->_busyLastUs = now;
+    // GxEPD2 does not sleep between BUSY polls when a callback is set
+    delay(1);
+}
+
+void TTRefreshMetrics::finish(TTRefreshLevel level, int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    uint32_t now = micros();
+    uint32_t& transfer = _current.phaseUs[TT_REFRESH_PHASE_TRANSFER];
+    transfer = transfer > _busyUs ? transfer - _busyUs : 0;
+    _current.phaseUs[TT_REFRESH_PHASE_BUSY] = _busyUs;
+    _current.phaseUs[TT_REFRESH_PHASE_TOTAL] = now - _flushStartUs;
+    _current.timeMs = millis();
+    _current.x = x;
+    _current.y = y;
+    _current.w = w;
+    _current.h = h;
+    _current.level = (uint8_t)level;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _window[_head] = _current;
+        _head = (_head + 1) % TT_REFRESH_METRICS_WINDOW;
+        if (_count < TT_REFRESH_METRICS_WINDOW) _count++;
+        _total++;
+    }
+    _last = _current;
+    TTInstanceOf<TTNotificationCenter>().post(TT_NOTIFICATION_REFRESH_METRICS, _last);
+}
+
+void TTRefreshMetrics::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _head = 0;
+    _count = 0;
+    _total = 0;
+}
+
+const char* TTRefreshMetrics::phaseName(TTRefreshPhase phase) {
+    static const char* const NAMES[TT_REFRESH_PHASE_COUNT] = { "render", "convert", "transfer", "busy", "total" };
+    return phase < TT_REFRESH_PHASE_COUNT ? NAMES[phase] : "?";
+}
+
+const char* TTRefreshMetrics::levelName(uint8_t level) {
+    switch (level) {
+        case TT_REFRESH_FAST: return "fast";
+        case TT_REFRESH_PARTIAL: return "partial";
+        case TT_REFRESH_FULL: return "full";
+        case TT_REFRESH_DEEP: return "deep";
+        default: return "?";
+    }
+}
+
+uint8_t TTRefreshMetrics::_bucket(uint32_t us) {
+    uint32_t ms = us / 1000;
+    uint8_t b = 0;
+    while (ms > 0 && b < TT_REFRESH_METRICS_BUCKETS - 1) {
+        ms >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void TTRefreshMetrics::report() {
+    uint32_t total;
+    uint16_t count;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        total = _total;
+        count = _count;
+    }
+    printf("Refresh metrics: %u flushes since reset, last %u in window\n", (unsigned)total, (unsigned)count);
+    for (int level = TT_REFRESH_FAST; level <= TT_REFRESH_DEEP; level++) {
+        _reportLevel(level);
+    }
+    fflush(stdout);
+}
+
+void TTRefreshMetrics::_reportLevel(int level) {
+    static TTRefreshMetricsPayload samples[TT_REFRESH_METRICS_WINDOW];   // Report runs on one task at a time
+    uint16_t n = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (uint16_t i = 0; i < _count; i++) {
+            if (_window[i].level == level) samples[n++] = _window[i];
+        }
+    }
+    if (n == 0) return;
+
+    uint32_t pixels = 0;
+    for (uint16_t i = 0; i < n; i++) pixels += (uint32_t)samples[i].w * samples[i].h;
+    printf("[%s] n=%u, avg area %u px\n", levelName(level), (unsigned)n, (unsigned)(pixels / n));
+
+    uint32_t values[TT_REFRESH_METRICS_WINDOW];
+    for (int phase = 0; phase < TT_REFRESH_PHASE_COUNT; phase++) {
+        uint16_t histogram[TT_REFRESH_METRICS_BUCKETS] = {};
+        for (uint16_t i = 0; i < n; i++) {
+            values[i] = samples[i].phaseUs[phase];
+            histogram[_bucket(values[i])]++;
+        }
+        std::sort(values, values + n);
+
+        // Histogram as "<upper ms>:count" for non-empty buckets
+        char hist[128];
+        size_t pos = 0;
+        hist[0] = '\0';
+        for (uint8_t b = 0; b < TT_REFRESH_METRICS_BUCKETS && pos < sizeof(hist); b++) {
+            if (histogram[b] == 0) continue;
+            int len = b == TT_REFRESH_METRICS_BUCKETS - 1
+                ? snprintf(hist + pos, sizeof(hist) - pos, " >%lu:%u", 1UL << (b - 1), histogram[b])
+                : snprintf(hist + pos, sizeof(hist) - pos, " <%lu:%u", 1UL << b, histogram[b]);
+            if (len > 0) pos += (size_t)len;
+        }
+
+        printf("  %-8s p50 %7.1f  p90 %7.1f  max %7.1f ms |%s\n", phaseName((TTRefreshPhase)phase),
+               values[n / 2] / 1000.0, values[(n * 9) / 10] / 1000.0, values[n - 1] / 1000.0, hist);
+    }
+}
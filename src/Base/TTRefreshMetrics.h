@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <mutex>
+#include "TTNotificationPayloads.h"
+#include "TTRefreshLevel.h"
+
+#define TT_REFRESH_METRICS_WINDOW      64       // Rolling window of flushes kept for the report
+#define TT_REFRESH_METRICS_BUCKETS     16       // Histogram buckets: <1 ms, then powers of two up to 16 s+
+#define TT_REFRESH_METRICS_BUSY_GAP_US 5000     // Busy callbacks further apart start a new BUSY wait
+
+/**
+ * Per-flush timing of the refresh path. TTLvglEpdDriver marks the phase boundaries of every flush
+ * (render, I1 conversion, SPI transfer, BUSY wait) and finish() stores the sample into a rolling
+ * window and posts it as TT_NOTIFICATION_REFRESH_METRICS. BUSY time is taken from GxEPD2's busy
+ * callback, so it covers every panel driver without changes to the library.
+ *
+ * Recording runs on the task that drives the panel (the panel task with TT_EPD_PIPELINE, else the UI task);
+ * report() / reset() are safe from any task (serial "metrics" command).
+ */
+class TTRefreshMetrics {
+public:
+    /** Starts a flush sample whose LVGL render took renderUs (timed on the UI task). */
+    void beginFlush(uint32_t renderUs);
+    /** Adds the render time of a later band of the same flush. */
+    void addRender(uint32_t renderUs) { _current.phaseUs[TT_REFRESH_PHASE_RENDER] += renderUs; }
+
+    /** Closes the current phase at now; the next phase starts here. */
+    void endPhase(TTRefreshPhase phase);
+
+    /** GxEPD2 busy callback: accumulates BUSY time and yields while the waveform runs. */
+    static void busyCallback(const void* param);
+
+    void finish(TTRefreshLevel level, int16_t x, int16_t y, uint16_t w, uint16_t h);
+    const TTRefreshMetricsPayload& last() const { return _last; }
+
+    /** Prints count, p50 / p90 / max and a log2 histogram per phase and refresh level to the console. */
+    void report();
+    void reset();
+
+    static const char* phaseName(TTRefreshPhase phase);
+    static const char* levelName(uint8_t level);
+
+private:
+    void _reportLevel(int level);
+    static uint8_t _bucket(uint32_t us);
+
+    TTRefreshMetricsPayload _current = {};
+    TTRefreshMetricsPayload _last = {};
+    uint32_t _markUs = 0;
+    uint32_t _flushStartUs = 0;
+    uint32_t _busyUs = 0;
+    uint32_t _busyLastUs = 0;
+
+    std::mutex _mutex;
+    TTRefreshMetricsPayload _window[TT_REFRESH_METRICS_WINDOW];
+    uint16_t _head = 0;
+    uint16_t _count = 0;
+    uint32_t _total = 0;
+};
@@ -1,10 +1,16 @@
+#define TT_LOG_MODULE UI
+
 #include "TTScreenPage.h"
 #include "ITTNavigationController.h"
 #include "Logger.h"
 #include "TTInstance.h"
+#include "TTNotificationCenter.h"
 #include "../Tasks/TTUITask.h"
 
 TTScreenPage::~TTScreenPage() {
+    for (uint32_t handle : _repeatHandles) {
+        TTInstanceOf<TTUITask>().cancelRepeat(handle);
+    }
     if (_group != nullptr) {
         lv_group_delete(_group);
         _group = nullptr;
@@ -39,6 +45,24 @@ void TTScreenPage::willDisappear() {
     LOG_I("Page[%s]: willDisappear()", _name);
 }
 
+void TTScreenPage::willSuspend() {
+    LOG_I("Page[%s]: willSuspend()", _name);
+    _suspended = true;
+    TTInstanceOf<TTNotificationCenter>().setObserverParked(this, true);
+}
+
+void TTScreenPage::willResume() {
+    LOG_I("Page[%s]: willResume()", _name);
+    _suspended = false;
+    TTInstanceOf<TTNotificationCenter>().setObserverParked(this, false);
+    // Re-arm rather than run here: the page is not the current page until after willAppear()
+    std::vector<std::function<void()>> held;
+    held.swap(_heldCallbacks);
+    for (size_t i = 0; i < held.size(); i++) {
+        runOnce(0, std::move(held[i]));
+    }
+}
+
 lv_group_t* TTScreenPage::createGroup() {
     if (_group == nullptr) {
         _group = lv_group_create();
@@ -59,13 +83,32 @@ void TTScreenPage::requestRefresh(TTRefreshLevel level) {
 }
 
 void TTScreenPage::runOnce(uint32_t delayMs, std::function<void()> callback) {
-    TTInstanceOf<TTUITask>().runOnce(delayMs, std::move(callback));
+    std::weak_ptr<bool> alive = _alive;
+    TTInstanceOf<TTUITask>().runOnce(delayMs, [this, alive, callback]() {
+        if (alive.expired()) return;
+        if (_suspended) {
+            _heldCallbacks.push_back(callback);
+            return;
+        }
+        callback();
+    });
 }
 
 uint32_t TTScreenPage::runRepeat(uint32_t intervalMs, std::function<void()> callback, bool executeImmediately) {
-    return TTInstanceOf<TTUITask>().runRepeat(intervalMs, std::move(callback), executeImmediately);
+    std::weak_ptr<bool> alive = _alive;
+    uint32_t handle = TTInstanceOf<TTUITask>().runRepeat(intervalMs, [this, alive, callback]() {
+        if (!alive.expired() && !_suspended) callback();
+    }, executeImmediately);
+    _repeatHandles.push_back(handle);
+    return handle;
 }
 
 void TTScreenPage::cancelRepeat(uint32_t handle) {
+    for (size_t i = 0; i < _repeatHandles.size(); i++) {
+        if (_repeatHandles[i] == handle) {
+            _repeatHandles.erase(_repeatHandles.begin() + (int)i);
+            break;
+        }
+    }
     TTInstanceOf<TTUITask>().cancelRepeat(handle);
 }
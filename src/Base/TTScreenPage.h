@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 #include <lvgl.h>
 #include "ITTScreenPage.h"
 #include "ITTNavigationController.h"
@@ -19,6 +21,7 @@ public:
     void addToFocusGroup(lv_obj_t* obj) override;
     void requestRefresh(TTRefreshLevel level = TT_REFRESH_PARTIAL) override;
 
+    /** UI task timers bound to the page: repeats are cancelled and pending runOnce callbacks dropped when it is destroyed. */
     void runOnce(uint32_t delayMs, std::function<void()> callback);
     uint32_t runRepeat(uint32_t intervalMs, std::function<void()> callback, bool executeImmediately = true);
     void cancelRepeat(uint32_t handle);
@@ -33,6 +36,15 @@ public:
     /** Called when this page is about to leave the top (setRoot/push/pop). */
     void willDisappear() override;
 
+    /**
+     * Called when the page is parked in the navigation cache (popped or pre-built). runRepeat ticks are
+     * skipped and runOnce callbacks held until willResume(); notifications to this page are parked.
+     */
+    void willSuspend() override;
+    /** Called when a cached page is taken out of the cache, before willAppear(). */
+    void willResume() override;
+    bool isSuspended() const { return _suspended; }
+
 protected:
     lv_group_t* createGroup();
 
@@ -46,4 +58,11 @@ protected:
     lv_obj_t* _screen = nullptr;
     lv_group_t* _group = nullptr;
     ITTNavigationController* _controller = nullptr;
+
+private:
+    bool _suspended = false;
+    std::vector<std::function<void()>> _heldCallbacks;
+    std::vector<uint32_t> _repeatHandles;
+    // Timer callbacks hold a weak_ptr; it expires with the page (e.g. evicted from the page cache)
+    std::shared_ptr<bool> _alive = std::make_shared<bool>(true);
 };
@@ -0,0 +1,359 @@
+#define TT_LOG_MODULE UI
+
+#include "TTSparkline.h"
+#include "TTDrawBufPassthroughDecoder.h"
+#include "Logger.h"
+#include <cstring>
+
+#include "core/lv_obj_private.h"
+#include "core/lv_obj_class_private.h"
+#include "misc/lv_area_private.h"
+
+#define MY_CLASS (&tt_sparkline_class)
+
+struct tt_sparkline_t {
+    lv_obj_t obj;
+    int16_t values[TT_SPARKLINE_MAX_POINTS];
+    uint16_t count;
+    uint16_t capacity;
+    tt_sparkline_mode_t mode;
+    bool auto_range;
+    int32_t range_min;
+    int32_t range_max;
+    int32_t min_span;
+};
+
+/* Chunk being rendered, in widget-relative coordinates. */
+struct chunk_ctx_t {
+    uint8_t* buf;
+    int32_t stride;
+    int32_t x1, y1, x2, y2;
+};
+
+static void constructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void event_cb(const lv_obj_class_t* class_p, lv_event_t* e);
+static void draw_main(lv_event_t* e);
+
+static void apply_points(tt_sparkline_t* sl, const int16_t* values, uint16_t count);
+static bool update_range(tt_sparkline_t* sl, const int16_t* values, uint16_t count);
+static void invalidate_columns(lv_obj_t* obj, int32_t x1, int32_t x2);
+static void point_columns(const tt_sparkline_t* sl, int32_t w, uint16_t i, int32_t* x1, int32_t* x2);
+static int32_t line_x(const tt_sparkline_t* sl, int32_t w, uint16_t i);
+static void bar_span(const tt_sparkline_t* sl, int32_t w, uint16_t i, int32_t* x1, int32_t* x2);
+static int32_t value_y(const tt_sparkline_t* sl, int32_t h, int16_t v);
+static inline void set_px(chunk_ctx_t* c, int32_t x, int32_t y);
+static void draw_line(chunk_ctx_t* c, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+
+const lv_obj_class_t tt_sparkline_class = {
+    .base_class = &lv_obj_class,
+    .constructor_cb = constructor,
+    .destructor_cb = nullptr,
+    .event_cb = event_cb,
+    .user_data = nullptr,
+    .name = "tt_sparkline",
+    .width_def = 96,
+    .height_def = 32,
+    .editable = LV_OBJ_CLASS_EDITABLE_INHERIT,
+    .group_def = LV_OBJ_CLASS_GROUP_DEF_INHERIT,
+    .instance_size = sizeof(tt_sparkline_t),
+    .theme_inheritable = LV_OBJ_CLASS_THEME_INHERITABLE_TRUE,
+};
+
+lv_obj_t* tt_sparkline_create(lv_obj_t* parent) {
+    lv_obj_t* obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    if (!obj) return nullptr;
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void tt_sparkline_set_mode(lv_obj_t* obj, tt_sparkline_mode_t mode) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    if (sl->mode == mode) return;
+    sl->mode = mode;
+    lv_obj_invalidate(obj);
+}
+
+void tt_sparkline_set_capacity(lv_obj_t* obj, uint16_t capacity) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    if (capacity == 0) capacity = 1;
+    if (capacity > TT_SPARKLINE_MAX_POINTS) {
+        LOG_W("TTSparkline: capacity %u clamped to %u", (unsigned)capacity, (unsigned)TT_SPARKLINE_MAX_POINTS);
+        capacity = TT_SPARKLINE_MAX_POINTS;
+    }
+    sl->capacity = capacity;
+    sl->count = 0;
+    lv_obj_invalidate(obj);
+}
+
+void tt_sparkline_set_range(lv_obj_t* obj, int16_t min, int16_t max) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    if (min == max) {
+        sl->auto_range = true;
+        update_range(sl, sl->values, sl->count);
+    } else {
+        sl->auto_range = false;
+        sl->range_min = min < max ? min : max;
+        sl->range_max = min < max ? max : min;
+    }
+    lv_obj_invalidate(obj);
+}
+
+void tt_sparkline_set_min_span(lv_obj_t* obj, int16_t span) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    sl->min_span = span > 0 ? span : 1;
+    if (sl->auto_range && update_range(sl, sl->values, sl->count)) {
+        lv_obj_invalidate(obj);
+    }
+}
+
+void tt_sparkline_set_points(lv_obj_t* obj, const int16_t* values, uint16_t count) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    if (count > sl->capacity) {
+        values += count - sl->capacity;
+        count = sl->capacity;
+    }
+    apply_points(sl, values, count);
+}
+
+void tt_sparkline_append(lv_obj_t* obj, int16_t value) {
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    int16_t next[TT_SPARKLINE_MAX_POINTS];
+    uint16_t keep = sl->count < sl->capacity ? sl->count : sl->capacity - 1;
+    memcpy(next, sl->values + (sl->count - keep), keep * sizeof(int16_t));
+    next[keep] = value;
+    apply_points(sl, next, keep + 1);
+}
+
+static void constructor(const lv_obj_class_t* class_p, lv_obj_t* obj) {
+    LV_UNUSED(class_p);
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+    sl->count = 0;
+    sl->capacity = TT_SPARKLINE_MAX_POINTS;
+    sl->mode = TT_SPARKLINE_MODE_LINE;
+    sl->auto_range = true;
+    sl->range_min = 0;
+    sl->range_max = 1;
+    sl->min_span = 1;
+    lv_obj_set_style_pad_all(obj, 0, 0);
+    lv_obj_set_style_border_width(obj, 0, 0);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void event_cb(const lv_obj_class_t* class_p, lv_event_t* e) {
+    lv_result_t res = lv_obj_event_base(class_p, e);
+    if (res != LV_RESULT_OK) return;
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_DRAW_MAIN) {
+        draw_main(e);
+    }
+}
+
+/* Store the new series and invalidate only the column spans of points that changed. */
+static void apply_points(tt_sparkline_t* sl, const int16_t* values, uint16_t count) {
+    lv_obj_t* obj = (lv_obj_t*)sl;
+    if (update_range(sl, values, count)) {
+        memcpy(sl->values, values, count * sizeof(int16_t));
+        sl->count = count;
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    int32_t w = lv_obj_get_width(obj);
+    uint16_t span = count > sl->count ? count : sl->count;
+    int32_t dirty_x1 = -1, dirty_x2 = -1;
+    for (uint16_t i = 0; i < span; i++) {
+        int16_t old_v = i < sl->count ? sl->values[i] : TT_SPARKLINE_NO_VALUE;
+        int16_t new_v = i < count ? values[i] : TT_SPARKLINE_NO_VALUE;
+        if (old_v == new_v) continue;
+
+        int32_t x1, x2;
+        point_columns(sl, w, i, &x1, &x2);
+        if (dirty_x1 >= 0 && x1 <= dirty_x2 + 1) {
+            if (x2 > dirty_x2) dirty_x2 = x2;
+            continue;
+        }
+        if (dirty_x1 >= 0) invalidate_columns(obj, dirty_x1, dirty_x2);
+        dirty_x1 = x1;
+        dirty_x2 = x2;
+    }
+    if (dirty_x1 >= 0) invalidate_columns(obj, dirty_x1, dirty_x2);
+
+    memcpy(sl->values, values, count * sizeof(int16_t));
+    sl->count = count;
+}
+
+/*
+ * Auto range: widen when a value falls outside, shrink only when the data uses less than half of
+ * the range. Returns true if the range changed (every point moves, so the caller redraws all).
+ */
+static bool update_range(tt_sparkline_t* sl, const int16_t* values, uint16_t count) {
+    if (!sl->auto_range) return false;
+
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (uint16_t i = 0; i < count; i++) {
+        if (values[i] == TT_SPARKLINE_NO_VALUE) continue;
+        if (values[i] < lo) lo = values[i];
+        if (values[i] > hi) hi = values[i];
+    }
+    if (lo > hi) return false;  // No data, keep the current range
+
+    bool inside = lo >= sl->range_min && hi <= sl->range_max;
+    bool tight = (hi - lo) * 2 >= (sl->range_max - sl->range_min);
+    if (inside && (tight || sl->range_max - sl->range_min <= sl->min_span)) return false;
+
+    if (hi - lo < sl->min_span) {
+        int32_t extra = sl->min_span - (hi - lo);
+        lo -= extra / 2;
+        hi = lo + sl->min_span;
+    }
+    sl->range_min = lo;
+    sl->range_max = hi;
+    return true;
+}
+
+static void invalidate_columns(lv_obj_t* obj, int32_t x1, int32_t x2) {
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    lv_area_t area;
+    area.x1 = coords.x1 + x1;
+    area.x2 = coords.x1 + x2;
+    area.y1 = coords.y1;
+    area.y2 = coords.y2;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+/* Columns affected by a change of point i: its bar, or both line segments touching it. */
+static void point_columns(const tt_sparkline_t* sl, int32_t w, uint16_t i, int32_t* x1, int32_t* x2) {
+    if (sl->mode == TT_SPARKLINE_MODE_BAR) {
+        bar_span(sl, w, i, x1, x2);
+        return;
+    }
+    *x1 = line_x(sl, w, i > 0 ? i - 1 : 0);
+    *x2 = line_x(sl, w, i + 1 < sl->capacity ? i + 1 : i);
+}
+
+static int32_t line_x(const tt_sparkline_t* sl, int32_t w, uint16_t i) {
+    if (sl->capacity <= 1) return 0;
+    return (int32_t)i * (w - 1) / (sl->capacity - 1);
+}
+
+static void bar_span(const tt_sparkline_t* sl, int32_t w, uint16_t i, int32_t* x1, int32_t* x2) {
+    *x1 = (int32_t)i * w / sl->capacity;
+    *x2 = (int32_t)(i + 1) * w / sl->capacity - 1;
+    if (*x2 - *x1 >= 2) (*x2)--;  // One column gap between bars when there is room
+}
+
+static int32_t value_y(const tt_sparkline_t* sl, int32_t h, int16_t v) {
+    int32_t span = sl->range_max - sl->range_min;
+    if (span <= 0) return h - 1;
+    int32_t y = (h - 1) - ((int32_t)v - sl->range_min) * (h - 1) / span;
+    if (y < 0) y = 0;
+    if (y > h - 1) y = h - 1;
+    return y;
+}
+
+static inline void set_px(chunk_ctx_t* c, int32_t x, int32_t y) {
+    if (x < c->x1 || x > c->x2 || y < c->y1 || y > c->y2) return;
+    int32_t cx = x - c->x1;
+    c->buf[(size_t)(y - c->y1) * (size_t)c->stride + (size_t)(cx >> 3)] &= (uint8_t)~(0x80 >> (cx & 7));
+}
+
+static void draw_line(chunk_ctx_t* c, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0;  // -|dy|
+    int32_t sx = x0 < x1 ? 1 : -1;
+    int32_t sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) {
+        set_px(c, x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+static void draw_main(lv_event_t* e) {
+    lv_obj_t* obj = (lv_obj_t*)lv_event_get_current_target(e);
+    tt_sparkline_t* sl = (tt_sparkline_t*)obj;
+
+    lv_layer_t* layer = lv_event_get_layer(e);
+    lv_area_t obj_coords;
+    lv_obj_get_coords(obj, &obj_coords);
+    lv_area_t clip;
+    if (!lv_area_intersect(&clip, &obj_coords, &layer->_clip_area)) return;
+
+    int32_t w = lv_area_get_width(&obj_coords);
+    int32_t h = lv_area_get_height(&obj_coords);
+    chunk_ctx_t c;
+    c.x1 = clip.x1 - obj_coords.x1;
+    c.y1 = clip.y1 - obj_coords.y1;
+    c.x2 = clip.x2 - obj_coords.x1;
+    c.y2 = clip.y2 - obj_coords.y1;
+    int32_t chunk_w = c.x2 - c.x1 + 1;
+    int32_t chunk_h = c.y2 - c.y1 + 1;
+    c.stride = (chunk_w + 7) / 8;
+    size_t chunk_buf_size = (size_t)c.stride * (size_t)chunk_h;
+
+    static uint8_t chunk_buf[TT_SPARKLINE_MAX_H * ((TT_SPARKLINE_MAX_W + 7) / 8)];
+    if (chunk_buf_size > sizeof(chunk_buf)) {
+        LOG_E("TTSparkline: %" LV_PRId32 "x%" LV_PRId32 " exceeds max size", chunk_w, chunk_h);
+        return;
+    }
+    c.buf = chunk_buf;
+    memset(chunk_buf, 0xFF, chunk_buf_size);
+
+    for (uint16_t i = 0; i < sl->count; i++) {
+        int16_t v = sl->values[i];
+        if (v == TT_SPARKLINE_NO_VALUE) continue;
+        int32_t y = value_y(sl, h, v);
+
+        if (sl->mode == TT_SPARKLINE_MODE_BAR) {
+            int32_t bx1, bx2;
+            bar_span(sl, w, i, &bx1, &bx2);
+            if (bx2 < c.x1 || bx1 > c.x2) continue;
+            for (int32_t x = bx1; x <= bx2; x++) {
+                for (int32_t yy = y; yy < h; yy++) set_px(&c, x, yy);
+            }
+            continue;
+        }
+
+        int32_t x = line_x(sl, w, i);
+        bool has_prev = i > 0 && sl->values[i - 1] != TT_SPARKLINE_NO_VALUE;
+        bool has_next = i + 1 < sl->count && sl->values[i + 1] != TT_SPARKLINE_NO_VALUE;
+        if (has_prev) {
+            int32_t px = line_x(sl, w, i - 1);
+            if (x < c.x1 || px > c.x2) continue;
+            draw_line(&c, px, value_y(sl, h, sl->values[i - 1]), x, y);
+        } else if (!has_next) {
+            set_px(&c, x, y);  // Isolated point between gaps
+        }
+    }
+
+    lv_draw_buf_t draw_buf;
+    memset(&draw_buf, 0, sizeof(draw_buf));
+    draw_buf.header.magic = LV_IMAGE_HEADER_MAGIC;
+    draw_buf.header.cf = LV_COLOR_FORMAT_I1;
+    draw_buf.header.flags = TT_DRAW_BUF_PASSTHROUGH_FLAG;
+    draw_buf.header.w = chunk_w;
+    draw_buf.header.h = chunk_h;
+    draw_buf.header.stride = (uint32_t)c.stride;
+    draw_buf.data_size = chunk_buf_size;
+    draw_buf.data = chunk_buf;
+    draw_buf.unaligned_data = chunk_buf;
+    draw_buf.handlers = TTDrawBufPassthroughDecoder_get_handlers();
+
+    lv_draw_image_dsc_t draw_dsc;
+    lv_draw_image_dsc_init(&draw_dsc);
+    draw_dsc.base.layer = layer;
+    lv_obj_init_draw_image_dsc(obj, LV_PART_MAIN, &draw_dsc);
+    draw_dsc.src = &draw_buf;
+    draw_dsc.opa = LV_OPA_COVER;
+    draw_dsc.rotation = 0;
+    draw_dsc.scale_x = LV_SCALE_NONE;
+    draw_dsc.scale_y = LV_SCALE_NONE;
+
+    lv_area_t coords = clip;
+    draw_dsc.image_area = coords;
+    lv_draw_image(layer, &draw_dsc, &coords);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <lvgl.h>
+
+/*
+ * 1bpp sparkline / bar chart widget for fixed-point series (e.g. TTSensorHistory::readSeries()).
+ * Rendered with integer Bresenham into an I1 chunk and blitted via the passthrough decoder, like
+ * TTStreamImage; LVGL's anti-aliased chart path is not used.
+ *
+ * Invalidation is incremental: tt_sparkline_set_points() / tt_sparkline_append() only invalidate the
+ * columns whose points changed (an append while not full reveals just the new segment). Scrolling a
+ * full series or a change of the auto range invalidates the whole widget.
+ * Points equal to TT_SPARKLINE_NO_VALUE are drawn as gaps.
+ */
+
+#define TT_SPARKLINE_MAX_POINTS  64
+#define TT_SPARKLINE_MAX_W       400
+#define TT_SPARKLINE_MAX_H       128
+#define TT_SPARKLINE_NO_VALUE    INT16_MIN   // Same sentinel as TT_SENSOR_HISTORY_INVALID
+
+typedef enum {
+    TT_SPARKLINE_MODE_LINE = 0,
+    TT_SPARKLINE_MODE_BAR,
+} tt_sparkline_mode_t;
+
+typedef struct tt_sparkline_t tt_sparkline_t;
+
+lv_obj_t* tt_sparkline_create(lv_obj_t* parent);
+
+void tt_sparkline_set_mode(lv_obj_t* obj, tt_sparkline_mode_t mode);
+/** Number of point slots across the width (<= TT_SPARKLINE_MAX_POINTS). Clears the series. */
+void tt_sparkline_set_capacity(lv_obj_t* obj, uint16_t capacity);
+/** Fixed value range; pass min == max to return to auto range. */
+void tt_sparkline_set_range(lv_obj_t* obj, int16_t min, int16_t max);
+/** Smallest span of the auto range, so sensor noise is not stretched to full height. */
+void tt_sparkline_set_min_span(lv_obj_t* obj, int16_t span);
+
+/** Replace the series (oldest first); the last `capacity` values are kept. */
+void tt_sparkline_set_points(lv_obj_t* obj, const int16_t* values, uint16_t count);
+/** Append one value; scrolls left by one point when full. */
+void tt_sparkline_append(lv_obj_t* obj, int16_t value);
+
+extern const lv_obj_class_t tt_sparkline_class;
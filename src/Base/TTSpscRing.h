@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer / single-consumer ring buffer with a fixed capacity N (power of two).
+ * The producer may be an ISR (push() is force-inlined so it stays in the caller's IRAM section).
+ * One slot is never used, so at most N - 1 items are held; push() fails and counts a drop when full.
+ */
+template<typename T, uint32_t N>
+class TTSpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "TTSpscRing: N must be a power of two");
+
+public:
+    __attribute__((always_inline)) inline bool push(const T& item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t next = (head + 1) & (N - 1);
+        if (next == _tail.load(std::memory_order_acquire)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        out = _items[tail];
+        _tail.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+    /** Returns the number of pushes rejected since the last call, and resets the counter. */
+    uint32_t takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    T _items[N];
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+    std::atomic<uint32_t> _dropped{0};
+};
@@ -1,11 +1,22 @@
+#define TT_LOG_MODULE STORAGE
+
 #include "TTStorage.h"
 #include "Logger.h"
 #include "ErrorCheck.h"
 #include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <memory>
+#include <mutex>
 
-bool TTStorage::begin()
+std::atomic<bool> TTStorage::_mounted{false};
+
+bool TTStorage::mount()
 {
-    // Mount LittleFS
+    if (_mounted.load(std::memory_order_acquire)) return true;
+    static std::mutex mountMutex;
+    std::lock_guard<std::mutex> lock(mountMutex);
+    if (_mounted.load(std::memory_order_relaxed)) return true;
+
     if (!LittleFS.begin()) {
         LOG_E("LittleFS mount failed");
         return false;
@@ -15,6 +26,18 @@ bool TTStorage::begin()
     // Get storage info
     LOG_I("Storage: %u KB total, %u KB used", (uint32_t)LittleFS.totalBytes() / 1024, (uint32_t)LittleFS.usedBytes() / 1024);
 
+    _mounted.store(true, std::memory_order_release);
+    return true;
+}
+
+bool TTStorage::mounted()
+{
+    return _mounted.load(std::memory_order_acquire);
+}
+
+bool TTStorage::begin()
+{
+    if (!mount()) return false;
     _initialized = true;
     return true;
 }
@@ -22,20 +45,13 @@ bool TTStorage::begin()
 bool TTStorage::saveConfig(const JsonDocument& config, const char* filename)
 {
     if (!_initialized) return false;
-    
-    File file = LittleFS.open(filename, "w");
-    if (!file) {
-        LOG_E("Failed to open file for writing: %s", filename);
-        return false;
-    }
-    
-    if (serializeJson(config, file) == 0) {
-        LOG_E("Failed to write to file: %s", filename);
-        file.close();
+
+    String json;
+    if (serializeJson(config, json) == 0) {
+        LOG_E("Failed to serialize config: %s", filename);
         return false;
     }
-        
-    file.close();
+    ERR_CHECK_RET(writeFileAtomic(filename, (const uint8_t*)json.c_str(), json.length()));
     LOG_I("Config saved to: %s", filename);
     return true;
 }
@@ -48,21 +64,101 @@ bool TTStorage::loadConfig(JsonDocument& config, const char* filename)
         return true;
     }
     
+    String json;
+    ERR_CHECK_RET(readFileChecked(filename, json));
+
+    DeserializationError error = deserializeJson(config, json);
+    if (error) {
+        LOG_E("Failed to parse config: %s", error.c_str());
+        return false;
+    }
+        
+    LOG_I("Config loaded from: %s", filename);
+    return true;
+}
+
+bool TTStorage::writeFileAtomic(const char* filename, const uint8_t* data, size_t len)
+{
+    if (!_initialized) return false;
+
+    String tmpName = String(filename) + TT_STORAGE_TMP_SUFFIX;
+    File file = LittleFS.open(tmpName, "w");
+    if (!file) {
+        LOG_E("Failed to open file for writing: %s", tmpName.c_str());
+        return false;
+    }
+
+    FileHeader header;
+    header.magic = TT_STORAGE_FILE_MAGIC;
+    header.length = (uint32_t)len;
+    header.crc = esp_rom_crc32_le(0, data, len);
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write(data, len) == len;
+    file.flush();  // fflush + fsync: data is on flash before the rename makes it visible
+    file.close();
+    if (!ok) {
+        LOG_E("Failed to write to file: %s", tmpName.c_str());
+        LittleFS.remove(tmpName);
+        return false;
+    }
+
+    // LittleFS rename atomically replaces an existing target
+    if (!LittleFS.rename(tmpName, filename)) {
+        LOG_E("Failed to rename %s to %s", tmpName.c_str(), filename);
+        return false;
+    }
+    return true;
+}
+
+// One read() of exactly len bytes; Stream::readString() goes byte by byte and waits out its timeout at EOF
+static bool readBytes(File& file, size_t len, String& out)
+{
+    std::unique_ptr<char[]> buf(new char[len + 1]);
+    if (file.read((uint8_t*)buf.get(), len) != len) return false;
+    buf[len] = '\0';
+    out = String();
+    return out.reserve((unsigned int)len) && out.concat(buf.get(), (unsigned int)len);
+}
+
+bool TTStorage::readFileChecked(const char* filename, String& out)
+{
+    if (!_initialized) return false;
+
     File file = LittleFS.open(filename, "r");
     if (!file) {
         LOG_E("Failed to open file for reading: %s", filename);
         return false;
     }
-    
-    DeserializationError error = deserializeJson(config, file);
-    if (error) {
-        LOG_E("Failed to parse config: %s", error.c_str());
+
+    size_t size = file.size();
+    FileHeader header;
+    if (size < sizeof(header) || file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != TT_STORAGE_FILE_MAGIC) {
+        // Legacy file written in place without a header: read it as-is, the next save upgrades it
+        file.seek(0);
+        bool ok = readBytes(file, size, out);
+        file.close();
+        if (!ok) {
+            LOG_E("Failed to read file: %s", filename);
+            return false;
+        }
+        LOG_W("File has no checksum header, read as legacy: %s", filename);
+        return true;
+    }
+
+    if (header.length != size - sizeof(header)) {
         file.close();
+        LOG_E("File length mismatch (torn write?): %s", filename);
         return false;
     }
+    bool ok = readBytes(file, header.length, out);
     file.close();
-        
-    LOG_I("Config loaded from: %s", filename);
+
+    if (!ok || out.length() != header.length ||
+        esp_rom_crc32_le(0, (const uint8_t*)out.c_str(), out.length()) != header.crc) {
+        LOG_E("File checksum mismatch: %s", filename);
+        return false;
+    }
     return true;
 }
 
@@ -2,16 +2,44 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <atomic>
 
 #define DEFAULT_CONFIG_FILE "/config.json"
 
+/** Suffix of the temp file written before the atomic rename. */
+#define TT_STORAGE_TMP_SUFFIX   ".tmp"
+/** Checked file header magic ("TTCF"); files without it are read as legacy plain JSON. */
+#define TT_STORAGE_FILE_MAGIC   0x46435454
+
 class TTStorage {
 public:
+    /**
+     * Mounts LittleFS once for every task (TTStorageTask at start, or whichever task needs files first);
+     * later calls return the first result without touching the filesystem.
+     */
+    static bool mount();
+    static bool mounted();
+
     bool begin();
     bool saveConfig(const JsonDocument& config, const char* filename = DEFAULT_CONFIG_FILE);    
     bool loadConfig(JsonDocument& config, const char* filename = DEFAULT_CONFIG_FILE);
     bool removeFile(const char* filename);
 
+    /**
+     * Crash-safe replace: write header (magic, length, CRC32) + data to filename.tmp, fsync,
+     * then rename over filename. A reader sees either the old or the new file, never a mix.
+     */
+    bool writeFileAtomic(const char* filename, const uint8_t* data, size_t len);
+    /** Read a file written by writeFileAtomic(); fails on a length or CRC mismatch. */
+    bool readFileChecked(const char* filename, String& out);
+
 private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t length;
+        uint32_t crc;
+    };
+
     bool _initialized = false;
+    static std::atomic<bool> _mounted;
 };
@@ -1,3 +1,5 @@
+#define TT_LOG_MODULE UI
+
 #include "TTStreamImage.h"
 #include "TTDrawBufPassthroughDecoder.h"
 #include "Logger.h"
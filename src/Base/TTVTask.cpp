@@ -3,8 +3,9 @@
 #include "ErrorCheck.h"
 #include <freertos/task.h>
 #include <Arduino.h>
+#include <algorithm>
 
-void TTVTask::start(int coreId, uint32_t loopDelayMs)
+void TTVTask::start(int coreId, uint32_t loopDelayMs, UBaseType_t priority)
 {
     _loopDelayMs = loopDelayMs;
     // Create queue for function pointers
@@ -21,8 +22,8 @@ void TTVTask::start(int coreId, uint32_t loopDelayMs)
         _name,      // Text name for the task
         _stackSize, // Stack size in bytes
         this,       // Parameter passed into the task
-        1,          // Task priority
-        NULL,       // Task handle
+        priority,   // Task priority
+        &_handle,   // Task handle
         coreId      // Core where the task should run
     );
 
@@ -34,6 +35,28 @@ void TTVTask::enqueue(std::function<void()> *func)
     if (_queue != nullptr)
     {
         xQueueSend(_queue, &func, portMAX_DELAY);
+        wake();
+    }
+}
+
+void TTVTask::wake()
+{
+    if (_handle != nullptr)
+    {
+        xTaskNotifyGive(_handle);
+    }
+}
+
+void IRAM_ATTR TTVTask::wakeFromISR()
+{
+    if (_handle != nullptr)
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(_handle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE)
+        {
+            portYIELD_FROM_ISR();
+        }
     }
 }
 
@@ -73,9 +96,10 @@ uint32_t TTVTask::runRepeat(uint32_t intervalMs, std::function<void()> callback,
 void TTVTask::cancelRepeat(uint32_t handle)
 {
     if (handle == 0) return;
-    for (size_t i = 0; i < _periodicTasks.size(); ++i) {
-        if (_periodicTasks[i].id == handle) {
-            _periodicTasks.erase(_periodicTasks.begin() + static_cast<std::ptrdiff_t>(i));
+    // Only marked: a callback may cancel (e.g. a page destroyed by navigation) while the list is walked
+    for (auto& task : _periodicTasks) {
+        if (task.id == handle) {
+            task.cancelled = true;
             break;
         }
     }
@@ -84,21 +108,25 @@ void TTVTask::cancelRepeat(uint32_t handle)
 void TTVTask::_checkPeriodicTasks()
 {
     uint32_t nowMs = millis();
-    std::vector<size_t> toRemove;
 
+    // Callbacks may register tasks, which can reallocate the vector: run each one from a local
     for (size_t i = 0; i < _periodicTasks.size(); ++i)
     {
-        auto& task = _periodicTasks[i];
-        if ((nowMs - task.lastExecuteTimeMs) >= task.intervalMs) {
-            task.callback();
-            if (task.runOnce)
-                toRemove.push_back(i);
-            else
-                task.lastExecuteTimeMs = nowMs;
+        if (_periodicTasks[i].cancelled || (nowMs - _periodicTasks[i].lastExecuteTimeMs) < _periodicTasks[i].intervalMs)
+            continue;
+        std::function<void()> callback = std::move(_periodicTasks[i].callback);
+        callback();
+        TTPeriodicTask& task = _periodicTasks[i];
+        if (task.runOnce) {
+            task.cancelled = true;
+        } else {
+            task.callback = std::move(callback);
+            task.lastExecuteTimeMs = nowMs;
         }
     }
-    for (auto it = toRemove.rbegin(); it != toRemove.rend(); ++it)
-        _periodicTasks.erase(_periodicTasks.begin() + static_cast<std::ptrdiff_t>(*it));
+    _periodicTasks.erase(std::remove_if(_periodicTasks.begin(), _periodicTasks.end(),
+                                        [](const TTPeriodicTask& task) { return task.cancelled; }),
+                         _periodicTasks.end());
 }
 
 void TTVTask::_task()
@@ -119,12 +147,16 @@ void TTVTask::_task()
             delete func;
         }
 
+        // Deliver notifications posted to this task since the last iteration
+        TTInstanceOf<TTNotificationCenter>().deliver(this);
+
         // Check periodic tasks
         _checkPeriodicTasks();
 
         // Run the main loop
         loop();
 
-        vTaskDelay(pdMS_TO_TICKS(_loopDelayMs));
+        // Sleep until the loop delay expires or wake() / wakeFromISR() is called
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(_loopDelayMs));
     }
 }
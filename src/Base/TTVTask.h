@@ -16,6 +16,7 @@ struct TTPeriodicTask {
     uint32_t intervalMs;
     uint32_t lastExecuteTimeMs;
     bool runOnce = false;
+    bool cancelled = false;     // Removed after the current _checkPeriodicTasks() pass
     uint32_t id = 0;
 };
 
@@ -26,15 +27,20 @@ public:
         : _name(name), _stackSize(stackSize) {}
     virtual ~TTVTask() = default;
 
-    void start(int coreId = 0, uint32_t loopDelayMs = 100);
-
-    template<typename PayloadType>
-    void postNotification(const char* name, const PayloadType& payload);
+    void start(int coreId = 0, uint32_t loopDelayMs = 100, UBaseType_t priority = 1);
 
     void runOnce(uint32_t delayMs, std::function<void()> callback);
     uint32_t runRepeat(uint32_t intervalMs, std::function<void()> callback, bool executeImmediately = true);
     void cancelRepeat(uint32_t handle);
 
+    /** Wake the task loop before its loop delay expires (e.g. new input or queued work). */
+    void wake();
+    /** Same as wake(), callable from an ISR. */
+    void wakeFromISR();
+
+    /** True when called from this task's own FreeRTOS task. */
+    bool isCurrentTask() const { return _handle != nullptr && xTaskGetCurrentTaskHandle() == _handle; }
+
 protected:
     virtual void setup() = 0;
     virtual void loop() = 0;
@@ -45,6 +51,7 @@ private:
     void _task();
     void _checkPeriodicTasks();
     QueueHandle_t _queue = nullptr;
+    TaskHandle_t _handle = nullptr;
     std::vector<TTPeriodicTask> _periodicTasks;
     uint32_t _nextPeriodicId = 0;
     uint32_t _taskStartTime = 0;
@@ -53,12 +60,4 @@ private:
     uint32_t _stackSize;
 };
 
-template<typename PayloadType>
-void TTVTask::postNotification(const char* name, const PayloadType& payload) {
-    auto* f = new std::function<void()>([name, payload]() {
-        TTInstanceOf<TTNotificationCenter>().post(name, payload);
-    });
-    enqueue(f);
-}
-
 #endif
\ No newline at end of file
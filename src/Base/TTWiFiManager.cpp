@@ -1,22 +1,20 @@
+#define TT_LOG_MODULE WIFI
+
 #include "TTWiFiManager.h"
 #include "Logger.h"
 #include "ErrorCheck.h"
 #include "TTInstance.h"
-#include "TTPreference.h"
+#include "TTNvsPreference.h"
 #include <ArduinoJson.h>
 #include <map>
 #include "Util.h"
 
-#define PREF_WIFI_SSID "wifi_ssid"
-#define PREF_WIFI_PASSWORD "wifi_password"
-
 bool TTWiFiManager::tryConfigWiFi()
 {
     // Try to connect to saved WiFi
-    String ssid, password;
-    auto &pref = TTInstanceOf<TTPreference>();
-    ERR_CHECK_RET(pref.get(PREF_WIFI_SSID, ssid, String("")));
-    ERR_CHECK_RET(pref.get(PREF_WIFI_PASSWORD, password, String("")));
+    auto &pref = TTInstanceOf<TTNvsPreference>();
+    String ssid = pref.get(TT_PREF_WIFI_SSID);
+    String password = pref.get(TT_PREF_WIFI_PASSWORD);
     if (!ssid.isEmpty() && !password.isEmpty())
     {
         if (_connectToWiFi(ssid, password)) {
@@ -26,9 +24,9 @@ bool TTWiFiManager::tryConfigWiFi()
         {
             LOG_W("Failed to connect to saved WiFi, removing credentials, restarting...");
 
-            pref.remove(PREF_WIFI_SSID);
-            pref.remove(PREF_WIFI_PASSWORD);
-            pref.sync();
+            pref.remove(TT_PREF_WIFI_SSID);
+            pref.remove(TT_PREF_WIFI_PASSWORD);
+            pref.flush();  // Restarting next, the writer task would not get to it
             
             delay(1000);
             ESP.restart();
@@ -191,10 +189,10 @@ void TTWiFiManager::_handleSave()
 
     // Save credentials
     LOG_I("Saving WiFi credentials: SSID: %s, Password: %s", ssid.c_str(), password.c_str());
-    auto &pref = TTInstanceOf<TTPreference>();
-    pref.set(PREF_WIFI_SSID, ssid);
-    pref.set(PREF_WIFI_PASSWORD, password);
-    pref.sync();
+    auto &pref = TTInstanceOf<TTNvsPreference>();
+    pref.set(TT_PREF_WIFI_SSID, ssid);
+    pref.set(TT_PREF_WIFI_PASSWORD, password);
+    pref.flush();  // Restarting next, the writer task would not get to it
 
     String response = "WiFi credentials saved. Device will restart in 3 seconds...";
     _server.send(200, "text/plain", response);
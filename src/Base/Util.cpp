@@ -1,5 +1,6 @@
 #include "Util.h"
 #include "Logger.h"
+#include "TTStorage.h"
 #ifdef ESP32
 #include <Arduino.h>
 #include <LittleFS.h>
@@ -51,7 +52,7 @@ namespace Util
             ESP.getFlashChipSize() / 1024 / 1024);
         LOG_I("Flash Speed: %u MHz", ESP.getFlashChipSpeed() / 1000000);
 
-        if (LittleFS.begin()) {
+        if (TTStorage::mount()) {
             LOG_I("LittleFS Total: %u KB", LittleFS.totalBytes() / 1024);
             LOG_I("LittleFS Used: %u KB", LittleFS.usedBytes() / 1024);
         }
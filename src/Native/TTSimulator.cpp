@@ -0,0 +1,282 @@
+#ifdef TT_NATIVE
+
+/**
+ * Host simulator (env:native). Starts the same tasks as main.cpp against the shims in
+ * lib/TTNativeShim, then plays a script of key presses and waits.
+ *
+ *   .pio/build/native/program [--virtual] [--waveform] [--frames DIR] [--fs DIR] [--seed DIR]
+ *                             [--script FILE|-] [--seconds N] [--goldens DIR] [--update-goldens]
+ *
+ * Script lines (# starts a comment):
+ *   l | r | c          click Left / Right / Center
+ *   L | R | C          long press
+ *   wait MS            let the tasks run for MS
+ *   sensor T H P       simulated temperature / humidity / pressure
+ *   serial TEXT        type a console line (e.g. "serial metrics")
+ *   pbm PATH           write the current panel content
+ *   golden NAME        compare the panel with DIR/NAME.pbm (--update-goldens rewrites it)
+ *   mark               start a new refresh budget window
+ *   expect K<=N ...    check the window: K is partial, full, deep or flipped; op is <=, == or >=
+ *   quit
+ *
+ * Refreshes are classed like TTRefreshLevel: a full waveform is deep, a partial waveform over the
+ * whole panel is full. A failed golden or expect makes the exit status 1, so scripts double as CI
+ * checks on both pixels and refresh cost.
+ */
+
+#include <Arduino.h>
+#include <TTSim.h>
+#include <unistd.h>
+#include <string>
+#include "Base/Logger.h"
+#include "Base/TTInstance.h"
+#include "Base/TTKeypadInput.h"
+#include "Base/TTLvglEpdDriver.h"
+#include "Tasks/TTUITask.h"
+#include "Tasks/TTSensorTask.h"
+#include "Tasks/TTStorageTask.h"
+#include "Tasks/TTLogTask.h"
+
+#define TT_SIM_CLICK_HOLD_MS   100
+#define TT_SIM_SETTLE_MS       500
+#define TT_SIM_LINE_MAX        256
+#define TT_SIM_PATH_MAX        512
+
+struct TTSimBudget {
+    uint32_t partial = 0;
+    uint32_t full = 0;
+    uint32_t deep = 0;
+    uint32_t flipped = 0;
+};
+
+static const char* _goldenDir = "golden";
+static bool _updateGoldens = false;
+static uint32_t _markIndex = 0;
+static unsigned _failures = 0;
+
+static void press(uint8_t pin, uint32_t holdMs) {
+    TTSim::setPin(pin, HIGH);
+    TTSim::advance(holdMs);
+    TTSim::setPin(pin, LOW);
+    TTSim::advance(TT_SIM_SETTLE_MS);
+}
+
+static int pinForKey(char key) {
+    switch (key) {
+        case 'l': case 'L': return PIN_BUTTONL;
+        case 'r': case 'R': return PIN_BUTTONR;
+        case 'c': case 'C': return PIN_BUTTONC;
+        default: return -1;
+    }
+}
+
+static TTSimBudget budgetSince(uint32_t first) {
+    TTSimBudget b;
+    TTSim::Refresh r;
+    for (uint32_t i = first; TTSim::refreshAt(i, r); i++) {
+        bool wholePanel = r.x == 0 && r.y == 0 && r.w * r.h == (uint32_t)EPD_WIDTH * EPD_HEIGHT;
+        if (r.full) b.deep++;
+        else if (wholePanel) b.full++;
+        else b.partial++;
+        b.flipped += r.flipped;
+    }
+    return b;
+}
+
+static bool readFile(const char* path, std::string& out) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == nullptr) return false;
+    char buf[4096];
+    size_t n;
+    out.clear();
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) out.append(buf, n);
+    fclose(fp);
+    return true;
+}
+
+/** Differing pixels between two P4 images, or -1 when the headers (size) differ. */
+static long pbmDiff(const std::string& a, const std::string& b) {
+    size_t headerA = a.find('\n', a.find('\n') + 1);
+    size_t headerB = b.find('\n', b.find('\n') + 1);
+    if (headerA == std::string::npos || a.compare(0, headerA, b, 0, headerB) != 0 || a.size() != b.size()) return -1;
+    long diff = 0;
+    for (size_t i = headerA + 1; i < a.size(); i++) diff += __builtin_popcount((uint8_t)(a[i] ^ b[i]));
+    return diff;
+}
+
+static void checkGolden(const char* name) {
+    char golden[TT_SIM_PATH_MAX];
+    char actual[TT_SIM_PATH_MAX];
+    snprintf(golden, sizeof(golden), "%s/%s.pbm", _goldenDir, name);
+    snprintf(actual, sizeof(actual), "%s/%s.actual.pbm", _goldenDir, name);
+
+    if (_updateGoldens) {
+        if (!TTSim::writePanelPbm(golden)) {
+            printf("GOLDEN %s: cannot write %s\n", name, golden);
+            _failures++;
+        }
+        return;
+    }
+
+    std::string expected, got;
+    if (!TTSim::writePanelPbm(actual) || !readFile(actual, got)) {
+        printf("GOLDEN %s: cannot write %s\n", name, actual);
+        _failures++;
+        return;
+    }
+    if (!readFile(golden, expected)) {
+        printf("GOLDEN %s: missing %s (record it with --update-goldens)\n", name, golden);
+        _failures++;
+        return;
+    }
+    long diff = pbmDiff(expected, got);
+    if (diff != 0) {
+        if (diff < 0) printf("GOLDEN %s: FAIL, size differs; actual frame in %s\n", name, actual);
+        else printf("GOLDEN %s: FAIL, %ld pixels differ; actual frame in %s\n", name, diff, actual);
+        _failures++;
+        return;
+    }
+    remove(actual);
+    printf("GOLDEN %s: ok\n", name);
+}
+
+static void checkBudget(char* terms) {
+    TTSimBudget b = budgetSince(_markIndex);
+    bool ok = true;
+    for (char* term = strtok(terms, " "); term != nullptr; term = strtok(nullptr, " ")) {
+        char key[16];
+        char op[3];
+        unsigned limit;
+        if (sscanf(term, "%15[a-z]%2[<=>]%u", key, op, &limit) != 3) {
+            printf("EXPECT: bad term '%s'\n", term);
+            ok = false;
+            continue;
+        }
+        uint32_t value;
+        if (strcmp(key, "partial") == 0) value = b.partial;
+        else if (strcmp(key, "full") == 0) value = b.full;
+        else if (strcmp(key, "deep") == 0) value = b.deep;
+        else if (strcmp(key, "flipped") == 0) value = b.flipped;
+        else {
+            printf("EXPECT: unknown counter '%s'\n", key);
+            ok = false;
+            continue;
+        }
+        bool pass = strcmp(op, "<=") == 0 ? value <= limit
+                  : strcmp(op, ">=") == 0 ? value >= limit
+                  : strcmp(op, "==") == 0 && value == limit;
+        if (!pass) {
+            printf("EXPECT %s: FAIL, got %u\n", term, (unsigned)value);
+            ok = false;
+        }
+    }
+    printf("EXPECT: %s (partial %u, full %u, deep %u, flipped %u)\n", ok ? "ok" : "FAIL",
+           (unsigned)b.partial, (unsigned)b.full, (unsigned)b.deep, (unsigned)b.flipped);
+    if (!ok) _failures++;
+}
+
+static bool runLine(char* line) {
+    char* end = line + strlen(line);
+    while (end > line && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ')) *--end = '\0';
+    while (*line == ' ') line++;
+    if (*line == '\0' || *line == '#') return true;
+
+    int pin = line[1] == '\0' ? pinForKey(line[0]) : -1;
+    if (pin >= 0) {
+        bool longPress = line[0] >= 'A' && line[0] <= 'Z';
+        press((uint8_t)pin, longPress ? TT_KEYPAD_LONG_PRESS_MS + TT_SIM_CLICK_HOLD_MS : TT_SIM_CLICK_HOLD_MS);
+        return true;
+    }
+
+    unsigned ms;
+    float t, h, p;
+    if (sscanf(line, "wait %u", &ms) == 1) {
+        TTSim::advance(ms);
+    } else if (sscanf(line, "sensor %f %f %f", &t, &h, &p) == 3) {
+        TTSim::setSensor(t, h, p);
+    } else if (strncmp(line, "serial ", 7) == 0) {
+        TTSim::serialInput(line + 7);
+        TTSim::serialInput("\n");
+        TTSim::advance(TT_LOG_LOOP_DELAY_MS * 2);
+    } else if (strncmp(line, "pbm ", 4) == 0) {
+        if (!TTSim::writePanelPbm(line + 4)) LOG_E("Simulator: cannot write %s", line + 4);
+    } else if (strncmp(line, "golden ", 7) == 0) {
+        checkGolden(line + 7);
+    } else if (strcmp(line, "mark") == 0) {
+        _markIndex = TTSim::refreshCount();
+    } else if (strncmp(line, "expect ", 7) == 0) {
+        checkBudget(line + 7);
+    } else if (strcmp(line, "quit") == 0) {
+        return false;
+    } else {
+        LOG_W("Simulator: unknown script line '%s'", line);
+    }
+    return true;
+}
+
+static void printSummary() {
+    TTSimBudget b = budgetSince(0);
+    printf("Simulated panel: %u refreshes (partial %u, full %u, deep %u), %u pixels flipped, %u ms\n",
+           (unsigned)(b.partial + b.full + b.deep), (unsigned)b.partial, (unsigned)b.full, (unsigned)b.deep,
+           (unsigned)b.flipped, (unsigned)millis());
+    TTInstanceOf<TTLvglEpdDriver>().metrics().report();
+    TTInstanceOf<TTLvglEpdDriver>().frames().report();
+    TTInstanceOf<TTLvglEpdDriver>().fastRegions().report();
+    if (_failures > 0) printf("%u check(s) failed\n", _failures);
+}
+
+int main(int argc, char** argv) {
+    const char* script = nullptr;
+    const char* fsRoot = ".pio/native/littlefs";
+    const char* seedDir = "data";
+    unsigned seconds = 10;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--virtual") == 0) TTSim::useVirtualClock(true);
+        else if (strcmp(argv[i], "--waveform") == 0) TTSim::setWaveformTiming(true);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue) TTSim::setFrameDir(argv[++i]);
+        else if (strcmp(argv[i], "--fs") == 0 && hasValue) fsRoot = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seedDir = argv[++i];
+        else if (strcmp(argv[i], "--script") == 0 && hasValue) script = argv[++i];
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue) seconds = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--goldens") == 0 && hasValue) _goldenDir = argv[++i];
+        else if (strcmp(argv[i], "--update-goldens") == 0) _updateGoldens = true;
+        else {
+            fprintf(stderr, "usage: %s [--virtual] [--waveform] [--frames DIR] [--fs DIR] [--seed DIR] "
+                            "[--script FILE|-] [--seconds N] [--goldens DIR] [--update-goldens]\n", argv[0]);
+            return 2;
+        }
+    }
+    TTSim::setFsRoot(fsRoot, seedDir);
+
+    // Same bring-up as setup() in main.cpp
+    _logger.setLevel(LOG_LEVEL_DEBUG);
+    Serial.begin(115200);
+    LOG_I("E-Paper Clock Demo (host simulator)");
+    TTInstanceOf<TTLogTask>().start(1, TT_LOG_LOOP_DELAY_MS, TT_LOG_TASK_PRIORITY);
+    TTInstanceOf<TTUITask>().start(0, TT_UI_LOOP_DELAY_MS);
+    TTInstanceOf<TTSensorTask>().start(1);
+    TTInstanceOf<TTStorageTask>().start(1, TT_STORAGE_LOOP_DELAY_MS);
+    TTSim::advance(TT_SIM_SETTLE_MS);
+
+    if (script != nullptr) {
+        FILE* in = strcmp(script, "-") == 0 ? stdin : fopen(script, "r");
+        if (in == nullptr) {
+            LOG_E("Simulator: cannot open script %s", script);
+            return 1;
+        }
+        char line[TT_SIM_LINE_MAX];
+        while (fgets(line, sizeof(line), in) != nullptr && runLine(line)) {}
+        if (in != stdin) fclose(in);
+    } else {
+        TTSim::advance(seconds * 1000);
+    }
+
+    TTSim::advance(TT_SIM_SETTLE_MS);
+    printSummary();
+    fflush(stdout);
+    // The tasks never return; leave without running static destructors under them
+    _exit(_failures > 0 ? 1 : 0);
+}
+
+#endif // TT_NATIVE
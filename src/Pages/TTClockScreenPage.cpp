@@ -1,11 +1,16 @@
+#define TT_LOG_MODULE UI
+
 #include "TTClockScreenPage.h"
 #include "../Base/Logger.h"
 #include "../Base/TTFontManager.h"
 #include "../Base/TTStreamImage.h"
+#include "../Base/TTSparkline.h"
+#include "../Base/TTDigitLabel.h"
 #include "../Base/TTInstance.h"
 #include "../Base/TTNotificationCenter.h"
 #include "../Base/TTNotificationPayloads.h"
 #include "../Tasks/TTSensorTask.h"
+#include "../Tasks/TTUITask.h"
 
 void TTClockScreenPage::buildContent(lv_obj_t* screen) {
     TTFontManager& fm = TTFontManager::instance();
@@ -38,16 +43,23 @@ void TTClockScreenPage::buildContent(lv_obj_t* screen) {
     lv_obj_set_style_bg_opa(timeContainer, LV_OPA_TRANSP, 0);
     lv_obj_align(timeContainer, LV_ALIGN_CENTER, 0, 18);
 
-    _timeLabel = lv_label_create(timeContainer);
-    lv_label_set_text(_timeLabel, "00:00");
-    lv_obj_set_style_text_color(_timeLabel, lv_color_black(), 0);
-    lv_obj_set_style_text_font(_timeLabel, font_48, 0);
+    // Fixed digit cells: a minute tick redraws only the digits that changed
+    _timeLabel = tt_digit_label_create(timeContainer);
+    tt_digit_label_set_font(_timeLabel, font_48);
+    tt_digit_label_set_text(_timeLabel, "00:00");
     lv_obj_align(_timeLabel, LV_ALIGN_CENTER, 0, 0);
 
     lv_obj_t* timeIcon = tt_stream_image_create(screen);
     tt_stream_image_set_src(timeIcon, "/icons/clock.png");
     lv_obj_align_to(timeIcon, timeContainer, LV_ALIGN_OUT_LEFT_MID, -6, 0);
 
+    // 24 h temperature trend from the hourly history tier
+    _trendChart = tt_sparkline_create(screen);
+    lv_obj_set_size(_trendChart, 72, 32);
+    tt_sparkline_set_capacity(_trendChart, TT_CLOCK_TREND_HOURS);
+    tt_sparkline_set_min_span(_trendChart, 100);  // 1.0 °C in history fixed point
+    lv_obj_align_to(_trendChart, timeContainer, LV_ALIGN_OUT_RIGHT_MID, 6, 0);
+
     _statusLabel = lv_label_create(screen);
     lv_label_set_text(_statusLabel, "");
     lv_obj_set_style_text_color(_statusLabel, lv_color_black(), 0);
@@ -59,13 +71,15 @@ void TTClockScreenPage::setup() {
     TTScreenPage::setup();
     _lastUpdateMs = millis();
     updateClockDisplay();
+    updateTrend();
 
     _repeatHandle = runRepeat(TT_CLOCK_TIMER_MS, [this]() { onTimerTick(); }, false);
 
     TTInstanceOf<TTNotificationCenter>().subscribe<TTSensorDataPayload>(
-        TT_NOTIFICATION_SENSOR_DATA_UPDATE, this,
+        TT_NOTIFICATION_SENSOR_DATA_UPDATE, this, &TTInstanceOf<TTUITask>(),
         [this](const TTSensorDataPayload& p) {
             updateSensorDisplay(p.temperature, p.humidity, p.pressure);
+            updateTrend();
             requestRefresh(TT_REFRESH_PARTIAL);
             LOG_I("Sensor data updated.");
         });
@@ -76,6 +90,14 @@ void TTClockScreenPage::willAppear() {
     TTInstanceOf<TTSensorTask>().requestSensorUpdateAsync();
 }
 
+void TTClockScreenPage::willResume() {
+    TTScreenPage::willResume();
+    // Ticks were skipped while cached; catch up before the screen is loaded
+    updateTime();
+    updateClockDisplay();
+    updateTrend();
+}
+
 void TTClockScreenPage::willDestroy() {
     if (_repeatHandle != 0) {
         cancelRepeat(_repeatHandle);
@@ -120,6 +142,13 @@ void TTClockScreenPage::onTimerTick() {
         needRefresh = true;
     }
 
+    // The sparkline shifts by one point when the history's hour bucket rolls over, whether or not a
+    // sensor publish happened (steady readings are threshold-gated and may not post for hours)
+    if (TTInstanceOf<TTSensorTask>().history().nowMinute() / 60 != _trendHour) {
+        updateTrend();
+        needRefresh = true;
+    }
+
     if (needRefresh) {
         updateClockDisplay();
         requestRefresh(TT_REFRESH_PARTIAL);
@@ -138,5 +167,14 @@ void TTClockScreenPage::updateSensorDisplay(float temperature, float humidity, f
 void TTClockScreenPage::updateClockDisplay() {
     char timeStr[8];
     snprintf(timeStr, sizeof(timeStr), "%02d:%02d", _hours, _minutes);
-    lv_label_set_text(_timeLabel, timeStr);
+    tt_digit_label_set_text(_timeLabel, timeStr);
+}
+
+void TTClockScreenPage::updateTrend() {
+    _trendHour = TTInstanceOf<TTSensorTask>().history().nowMinute() / 60;
+    int16_t series[TT_CLOCK_TREND_HOURS];
+    TTInstanceOf<TTSensorTask>().history().readSeries(
+        TT_HISTORY_TIER_HOUR, TT_SENSOR_CH_TEMPERATURE, TT_CLOCK_TREND_HOURS, series);
+    // Within an hour only the last point moves, so this invalidates just the newest segment
+    tt_sparkline_set_points(_trendChart, series, TT_CLOCK_TREND_HOURS);
 }
@@ -4,13 +4,16 @@
 #include "../Base/TTScreenPage.h"
 
 #define TT_CLOCK_TIMER_MS  1000
+#define TT_CLOCK_TREND_HOURS  24
+#define TT_CLOCK_PAGE_NAME    "Clock"
 
 class TTClockScreenPage : public TTScreenPage {
 public:
-    TTClockScreenPage() : TTScreenPage("Clock") {}
+    TTClockScreenPage() : TTScreenPage(TT_CLOCK_PAGE_NAME) {}
 
     void setup() override;
     void willAppear() override;
+    void willResume() override;
     void willDestroy() override;
 
 protected:
@@ -21,13 +24,16 @@ private:
     void updateTime();
     void updateSensorDisplay(float temperature, float humidity, float pressure);
     void updateClockDisplay();
+    void updateTrend();
 
     uint32_t _repeatHandle = 0;
     lv_obj_t* _titleLabel = nullptr;
     lv_obj_t* _timeLabel = nullptr;
     lv_obj_t* _statusLabel = nullptr;
+    lv_obj_t* _trendChart = nullptr;
     uint8_t _hours = 0;
     uint8_t _minutes = 0;
     uint8_t _seconds = 0;
     unsigned long _lastUpdateMs = 0;
+    uint32_t _trendHour = 0;        // History hour bucket the sparkline was last read for
 };
@@ -149,3 +149,12 @@ void TTHomePage::setup() {
             nullptr);
     });
 }
+
+void TTHomePage::willAppear() {
+    TTScreenPage::willAppear();
+    // The clock is the usual next stop; build it while the user is still looking at Home
+    ITTNavigationController* nav = getNavigationController();
+    if (nav != nullptr && !nav->isKnown(TT_CLOCK_PAGE_NAME)) {
+        nav->prebuildPage(std::unique_ptr<TTScreenPage>(new TTClockScreenPage()));
+    }
+}
@@ -32,6 +32,7 @@ public:
 protected:
     void buildContent(lv_obj_t* screen) override;
     void setup() override;
+    void willAppear() override;
 
 private:
     std::array<HomeItem, 3> _items;
@@ -0,0 +1,71 @@
+#include "TTLogTask.h"
+#include "../Base/Logger.h"
+
+void TTLogTask::setup() {
+    _logger.attachDrainTask(this);
+}
+
+void TTLogTask::loop() {
+    _logger.drain();
+    _pollConsole();
+}
+
+void TTLogTask::addCommand(const char* name, const char* help, TTConsoleCommand handler) {
+    std::lock_guard<std::mutex> lock(_commandMutex);
+    Command cmd;
+    cmd.name = name;
+    cmd.help = help;
+    cmd.handler = std::move(handler);
+    _commands.push_back(std::move(cmd));
+}
+
+void TTLogTask::_pollConsole() {
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+        if (c == '\r' || c == '\n') {
+            if (!_overflow && _lineLen > 0) {
+                _line[_lineLen] = '\0';
+                _dispatch(_line);
+            }
+            _lineLen = 0;
+            _overflow = false;
+        } else if (_lineLen + 1 < sizeof(_line)) {
+            _line[_lineLen++] = (char)c;
+        } else {
+            _overflow = true;
+        }
+    }
+}
+
+void TTLogTask::_dispatch(char* line) {
+    char* args = strchr(line, ' ');
+    if (args != nullptr) {
+        *args++ = '\0';
+        while (*args == ' ') args++;
+    } else {
+        args = line + strlen(line);
+    }
+
+    TTConsoleCommand handler;
+    {
+        std::lock_guard<std::mutex> lock(_commandMutex);
+        if (strcmp(line, "help") == 0) {
+            printf("Commands:\n");
+            for (const Command& cmd : _commands) printf("  %-10s %s\n", cmd.name, cmd.help);
+            fflush(stdout);
+            return;
+        }
+        for (const Command& cmd : _commands) {
+            if (strcmp(line, cmd.name) == 0) {
+                handler = cmd.handler;
+                break;
+            }
+        }
+    }
+    if (!handler) {
+        LOG_W("Console: unknown command '%s' (try 'help')", line);
+        return;
+    }
+    handler(args);
+}
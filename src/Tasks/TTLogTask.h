@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "../Base/TTVTask.h"
+
+// Below every other task (priority 1) so log output only uses otherwise idle time
+#define TT_LOG_TASK_PRIORITY   tskIDLE_PRIORITY
+#define TT_LOG_LOOP_DELAY_MS   100
+
+#define TT_LOG_CONSOLE_LINE_MAX  64     // Longer command lines are discarded
+
+typedef std::function<void(const char* args)> TTConsoleCommand;
+
+/**
+ * Drains the deferred logger: formats captured records and writes them to the UART.
+ * Also serves a line-based serial console: "<name> [args]" runs a command registered with
+ * addCommand() on this task, "help" lists them.
+ */
+class TTLogTask : public TTVTask {
+public:
+    TTLogTask() : TTVTask("TTLogTask", 4096) {}
+
+    /** Safe from any task. The handler runs on TTLogTask. */
+    void addCommand(const char* name, const char* help, TTConsoleCommand handler);
+
+protected:
+    void setup() override;
+    void loop() override;
+
+private:
+    struct Command {
+        const char* name;
+        const char* help;
+        TTConsoleCommand handler;
+    };
+
+    void _pollConsole();
+    void _dispatch(char* line);
+
+    std::mutex _commandMutex;
+    std::vector<Command> _commands;
+    char _line[TT_LOG_CONSOLE_LINE_MAX];
+    size_t _lineLen = 0;
+    bool _overflow = false;
+};
@@ -0,0 +1,14 @@
+#define TT_LOG_MODULE EPD
+
+#include "TTPanelTask.h"
+#include "../Base/TTInstance.h"
+#include "../Base/TTLvglEpdDriver.h"
+#include "../Base/Logger.h"
+
+void TTPanelTask::setup() {
+    LOG_I("Panel task started.");
+}
+
+void TTPanelTask::loop() {
+    TTInstanceOf<TTLvglEpdDriver>().servicePanel();
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Base/TTVTask.h"
+
+// Woken for every frame the UI task hands over; the timeout is only a fallback
+#define TT_PANEL_LOOP_DELAY_MS   1000
+#define TT_PANEL_TASK_CORE       1
+#define TT_PANEL_TASK_PRIORITY   2
+
+/**
+ * Panel output task (TT_EPD_PIPELINE): owns SPI and BUSY. Takes the latest frame TTLvglEpdDriver
+ * posted, converts it into the GxEPD2 buffer, releases the LVGL draw buffer and drives the waveform,
+ * so the UI task keeps rendering meanwhile.
+ */
+class TTPanelTask : public TTVTask {
+public:
+    TTPanelTask() : TTVTask("TTPanelTask", 4096) {}
+
+protected:
+    void setup() override;
+    void loop() override;
+};
@@ -0,0 +1,305 @@
+#define TT_LOG_MODULE SENSOR
+
+#include "TTSensorHistory.h"
+#include "../Base/Logger.h"
+#include "../Base/TTStorage.h"
+#include <LittleFS.h>
+#include <esp_timer.h>
+#include <math.h>
+
+#define TT_SENSOR_HISTORY_RECORD_MAGIC  0xA5
+
+static const float TT_SENSOR_HISTORY_SCALE[TT_SENSOR_CHANNEL_COUNT] = { 100.0f, 100.0f, 10.0f };
+static const uint16_t TT_SENSOR_HISTORY_PERIOD_MIN[TT_HISTORY_TIER_COUNT] = { 1, 60, 24 * 60 };
+
+int16_t TTSensorHistory::toFixed(TTSensorChannelIndex channel, float value) {
+    long v = lroundf(value * TT_SENSOR_HISTORY_SCALE[channel]);
+    if (v > INT16_MAX) v = INT16_MAX;
+    if (v <= TT_SENSOR_HISTORY_INVALID) v = TT_SENSOR_HISTORY_INVALID + 1;
+    return (int16_t)v;
+}
+
+float TTSensorHistory::toFloat(TTSensorChannelIndex channel, int16_t value) {
+    return (float)value / TT_SENSOR_HISTORY_SCALE[channel];
+}
+
+uint8_t TTSensorHistory::_crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void TTSensorHistory::_initTiers() {
+    TTSensorHistoryBucket* buckets[TT_HISTORY_TIER_COUNT] = { _minutes, _hours, _days };
+    uint8_t* dirty[TT_HISTORY_TIER_COUNT] = { _minutesDirty, _hoursDirty, _daysDirty };
+    uint16_t sizes[TT_HISTORY_TIER_COUNT] = { TT_SENSOR_HISTORY_MINUTES, TT_SENSOR_HISTORY_HOURS, TT_SENSOR_HISTORY_DAYS };
+
+    for (uint8_t t = 0; t < TT_HISTORY_TIER_COUNT; t++) {
+        Tier& tier = _tiers[t];
+        tier.buckets = buckets[t];
+        tier.dirty = dirty[t];
+        tier.size = sizes[t];
+        tier.periodMinutes = TT_SENSOR_HISTORY_PERIOD_MIN[t];
+        tier.hasOpen = false;
+        tier.openStamp = 0;
+        memset(tier.buckets, 0, sizeof(TTSensorHistoryBucket) * tier.size);
+        memset(tier.dirty, 0, tier.size);
+    }
+}
+
+bool TTSensorHistory::begin() {
+    if (_ready) return true;
+    if (!TTStorage::mounted()) return false;  // TTStorageTask mounts; retried on the next sample
+    // A leftover temp file means a compaction was interrupted before the rename; the log is still intact.
+    if (LittleFS.exists(TT_SENSOR_HISTORY_TMP_FILE)) {
+        LittleFS.remove(TT_SENSOR_HISTORY_TMP_FILE);
+    }
+    _replay();
+    _lastCheckpointMinute = nowMinute();
+    _ready = true;
+    return true;
+}
+
+uint32_t TTSensorHistory::nowMinute() const {
+    // 64-bit microseconds since boot: millis() would wrap after 49.7 days and send the minute backwards
+    return _minuteBase + (uint32_t)(esp_timer_get_time() / 60000000LL);
+}
+
+void TTSensorHistory::_placeBucket(Tier& tier, const TTSensorHistoryBucket& bucket) {
+    TTSensorHistoryBucket& slot = tier.buckets[bucket.stamp % tier.size];
+    if (slot.count == 0 || bucket.stamp >= slot.stamp) {
+        slot = bucket;
+    }
+}
+
+bool TTSensorHistory::_replay() {
+    if (!LittleFS.exists(TT_SENSOR_HISTORY_FILE)) {
+        LOG_I("SensorHistory: no checkpoint, starting empty");
+        return true;
+    }
+    File file = LittleFS.open(TT_SENSOR_HISTORY_FILE, "r");
+    if (!file) {
+        LOG_E("SensorHistory: failed to open %s", TT_SENSOR_HISTORY_FILE);
+        return false;
+    }
+
+    uint32_t records = 0;
+    uint32_t lastMinute = 0;
+    bool torn = false;
+    Record rec;
+    while (file.available() > 0) {
+        if (file.read((uint8_t*)&rec, sizeof(rec)) != sizeof(rec) ||
+            rec.magic != TT_SENSOR_HISTORY_RECORD_MAGIC ||
+            rec.tier >= TT_HISTORY_TIER_COUNT ||
+            rec.crc != _crc8((const uint8_t*)&rec, sizeof(rec) - 1)) {
+            torn = true;  // Power loss mid-append; everything before it is valid
+            break;
+        }
+        Tier& tier = _tiers[rec.tier];
+        _placeBucket(tier, rec.bucket);
+        uint32_t endMinute = rec.bucket.stamp * tier.periodMinutes + tier.periodMinutes - 1;
+        if (rec.tier == TT_HISTORY_TIER_MINUTE && endMinute > lastMinute) lastMinute = endMinute;
+        records++;
+    }
+    file.close();
+
+    if (records > 0) {
+        _minuteBase = lastMinute + 1;
+    }
+    LOG_I("SensorHistory: replayed %u records, resuming at minute %u", (unsigned)records, (unsigned)_minuteBase);
+
+    if (torn) {
+        LOG_W("SensorHistory: discarding torn tail of %s", TT_SENSOR_HISTORY_FILE);
+        return _compact();
+    }
+    return true;
+}
+
+void TTSensorHistory::_addToTier(Tier& tier, uint32_t minute, const int16_t fixed[TT_SENSOR_CHANNEL_COUNT], const bool valid[TT_SENSOR_CHANNEL_COUNT]) {
+    uint32_t stamp = minute / tier.periodMinutes;
+    uint16_t slot = stamp % tier.size;
+    TTSensorHistoryBucket& b = tier.buckets[slot];
+
+    if (!tier.hasOpen || stamp != tier.openStamp) {
+        tier.hasOpen = true;
+        tier.openStamp = stamp;
+        if (b.count > 0 && b.stamp == stamp) {
+            // Reopening a bucket restored from the log: seed the running sums from its rollup
+            for (uint8_t c = 0; c < TT_SENSOR_CHANNEL_COUNT; c++) {
+                bool has = b.ch[c].avg != TT_SENSOR_HISTORY_INVALID;
+                tier.n[c] = has ? b.count : 0;
+                tier.sum[c] = has ? (int32_t)b.ch[c].avg * b.count : 0;
+            }
+        } else {
+            b.stamp = stamp;
+            b.count = 0;
+            for (uint8_t c = 0; c < TT_SENSOR_CHANNEL_COUNT; c++) {
+                b.ch[c].min = b.ch[c].max = b.ch[c].avg = TT_SENSOR_HISTORY_INVALID;
+                tier.n[c] = 0;
+                tier.sum[c] = 0;
+            }
+        }
+    }
+
+    if (b.count < UINT16_MAX) b.count++;
+    for (uint8_t c = 0; c < TT_SENSOR_CHANNEL_COUNT; c++) {
+        if (!valid[c] || tier.n[c] == UINT16_MAX) continue;
+        TTSensorHistoryStat& s = b.ch[c];
+        if (tier.n[c] == 0) {
+            s.min = s.max = fixed[c];
+        } else {
+            if (fixed[c] < s.min) s.min = fixed[c];
+            if (fixed[c] > s.max) s.max = fixed[c];
+        }
+        tier.n[c]++;
+        tier.sum[c] += fixed[c];
+        s.avg = (int16_t)(tier.sum[c] / tier.n[c]);
+    }
+    tier.dirty[slot] = 1;
+}
+
+void TTSensorHistory::addSample(uint32_t minute, const float values[TT_SENSOR_CHANNEL_COUNT], const bool valid[TT_SENSOR_CHANNEL_COUNT]) {
+    int16_t fixed[TT_SENSOR_CHANNEL_COUNT];
+    for (uint8_t c = 0; c < TT_SENSOR_CHANNEL_COUNT; c++) {
+        fixed[c] = valid[c] ? toFixed((TTSensorChannelIndex)c, values[c]) : TT_SENSOR_HISTORY_INVALID;
+    }
+
+    portENTER_CRITICAL(&_lock);
+    for (uint8_t t = 0; t < TT_HISTORY_TIER_COUNT; t++) {
+        _addToTier(_tiers[t], minute, fixed, valid);
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+bool TTSensorHistory::checkpoint(bool force) {
+    if (!_ready) return false;
+    uint32_t minute = nowMinute();
+    if (!force && (minute - _lastCheckpointMinute) < TT_SENSOR_HISTORY_CHECKPOINT_MIN) return true;
+    _lastCheckpointMinute = minute;
+
+    File file = LittleFS.open(TT_SENSOR_HISTORY_FILE, "a");
+    if (!file) {
+        LOG_E("SensorHistory: failed to open %s for append", TT_SENSOR_HISTORY_FILE);
+        return false;
+    }
+
+    uint32_t written = 0;
+    bool ok = true;
+    Record rec;
+    rec.magic = TT_SENSOR_HISTORY_RECORD_MAGIC;
+    for (uint8_t t = 0; t < TT_HISTORY_TIER_COUNT && ok; t++) {
+        Tier& tier = _tiers[t];
+        rec.tier = t;
+        for (uint16_t i = 0; i < tier.size; i++) {
+            portENTER_CRITICAL(&_lock);
+            bool dirty = tier.dirty[i] != 0;
+            if (dirty) {
+                rec.bucket = tier.buckets[i];
+                tier.dirty[i] = 0;
+            }
+            portEXIT_CRITICAL(&_lock);
+            if (!dirty) continue;
+
+            rec.crc = _crc8((const uint8_t*)&rec, sizeof(rec) - 1);
+            if (file.write((const uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) {
+                tier.dirty[i] = 1;
+                ok = false;
+                break;
+            }
+            written++;
+        }
+    }
+    size_t fileSize = file.size();
+    file.close();
+
+    if (!ok) {
+        LOG_E("SensorHistory: checkpoint write failed after %u records", (unsigned)written);
+        return false;
+    }
+    LOG_D("SensorHistory: checkpoint appended %u records (%u bytes)", (unsigned)written, (unsigned)fileSize);
+
+    if (fileSize > TT_SENSOR_HISTORY_FILE_MAX) {
+        return _compact();
+    }
+    return true;
+}
+
+bool TTSensorHistory::_compact() {
+    File file = LittleFS.open(TT_SENSOR_HISTORY_TMP_FILE, "w");
+    if (!file) {
+        LOG_E("SensorHistory: failed to open %s", TT_SENSOR_HISTORY_TMP_FILE);
+        return false;
+    }
+
+    uint32_t written = 0;
+    Record rec;
+    rec.magic = TT_SENSOR_HISTORY_RECORD_MAGIC;
+    for (uint8_t t = 0; t < TT_HISTORY_TIER_COUNT; t++) {
+        Tier& tier = _tiers[t];
+        rec.tier = t;
+        for (uint16_t i = 0; i < tier.size; i++) {
+            portENTER_CRITICAL(&_lock);
+            rec.bucket = tier.buckets[i];
+            portEXIT_CRITICAL(&_lock);
+            if (rec.bucket.count == 0) continue;
+
+            rec.crc = _crc8((const uint8_t*)&rec, sizeof(rec) - 1);
+            if (file.write((const uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) {
+                LOG_E("SensorHistory: compaction write failed");
+                file.close();
+                LittleFS.remove(TT_SENSOR_HISTORY_TMP_FILE);
+                return false;
+            }
+            written++;
+        }
+    }
+    file.close();
+
+    // LittleFS rename replaces the target atomically: a reboot sees either the old log or the snapshot
+    if (!LittleFS.rename(TT_SENSOR_HISTORY_TMP_FILE, TT_SENSOR_HISTORY_FILE)) {
+        LOG_E("SensorHistory: failed to replace %s", TT_SENSOR_HISTORY_FILE);
+        return false;
+    }
+    LOG_I("SensorHistory: compacted log to %u records", (unsigned)written);
+    return true;
+}
+
+bool TTSensorHistory::read(TTSensorHistoryTier tier, uint16_t ago, TTSensorHistoryBucket& out) const {
+    const Tier& t = _tiers[tier];
+    uint32_t current = nowMinute() / t.periodMinutes;
+    if (ago >= t.size || ago > current) return false;
+    uint32_t stamp = current - ago;
+
+    portENTER_CRITICAL(&_lock);
+    const TTSensorHistoryBucket& b = t.buckets[stamp % t.size];
+    bool found = b.count > 0 && b.stamp == stamp;
+    if (found) out = b;
+    portEXIT_CRITICAL(&_lock);
+    return found;
+}
+
+uint16_t TTSensorHistory::readSeries(TTSensorHistoryTier tier, TTSensorChannelIndex channel, uint16_t count, int16_t* out) const {
+    const Tier& t = _tiers[tier];
+    uint32_t current = nowMinute() / t.periodMinutes;
+    uint16_t validCount = 0;
+
+    portENTER_CRITICAL(&_lock);
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t ago = count - 1 - i;
+        out[i] = TT_SENSOR_HISTORY_INVALID;
+        if (ago >= t.size || ago > current) continue;
+        uint32_t stamp = current - ago;
+        const TTSensorHistoryBucket& b = t.buckets[stamp % t.size];
+        if (b.count > 0 && b.stamp == stamp) {
+            out[i] = b.ch[channel].avg;
+            if (out[i] != TT_SENSOR_HISTORY_INVALID) validCount++;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+    return validCount;
+}
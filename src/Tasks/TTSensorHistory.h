@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+#define TT_SENSOR_CHANNEL_COUNT  3      // temperature, humidity, pressure
+
+#define TT_SENSOR_HISTORY_MINUTES  60   // Minute tier: last hour
+#define TT_SENSOR_HISTORY_HOURS    48   // Hourly tier: last two days
+#define TT_SENSOR_HISTORY_DAYS     31   // Daily tier: last month
+
+#define TT_SENSOR_HISTORY_FILE            "/history.bin"
+#define TT_SENSOR_HISTORY_TMP_FILE        "/history.tmp"
+#define TT_SENSOR_HISTORY_CHECKPOINT_MIN  30           // Append dirty buckets every N minutes
+#define TT_SENSOR_HISTORY_FILE_MAX        (96 * 1024)  // Compact the log beyond this size
+
+/** Marks a channel that had no samples in a bucket. */
+#define TT_SENSOR_HISTORY_INVALID  INT16_MIN
+
+enum TTSensorChannelIndex {
+    TT_SENSOR_CH_TEMPERATURE = 0,   // 0.01 °C
+    TT_SENSOR_CH_HUMIDITY,          // 0.01 %RH
+    TT_SENSOR_CH_PRESSURE           // 0.1 hPa
+};
+
+enum TTSensorHistoryTier {
+    TT_HISTORY_TIER_MINUTE = 0,
+    TT_HISTORY_TIER_HOUR,
+    TT_HISTORY_TIER_DAY,
+    TT_HISTORY_TIER_COUNT
+};
+
+struct TTSensorHistoryStat {
+    int16_t min;
+    int16_t max;
+    int16_t avg;
+};
+
+/** One min/max/avg rollup; stamp is the period index (minute, hour or day number). */
+struct TTSensorHistoryBucket {
+    uint32_t stamp;
+    uint16_t count;
+    TTSensorHistoryStat ch[TT_SENSOR_CHANNEL_COUNT];
+};
+static_assert(sizeof(TTSensorHistoryBucket) == 24, "TTSensorHistoryBucket is part of the on-flash record format");
+
+/**
+ * Fixed-memory sensor time series with minute / hourly / daily tiers. Every sample is folded into the
+ * open bucket of each tier, so rollups are always current and reading any bucket is O(1).
+ * Values are stored as 16-bit fixed point (see TTSensorChannelIndex for units).
+ *
+ * Time is a monotonic minute counter (esp_timer, 64-bit) that continues from the last checkpoint after a reboot.
+ * Persistence is an append-only log of dirty buckets (replayed in order on begin()); the log is
+ * compacted into a snapshot through a temp file + rename once it exceeds TT_SENSOR_HISTORY_FILE_MAX.
+ *
+ * addSample() / checkpoint() run on the sensor task; the read functions are safe from any task.
+ */
+class TTSensorHistory {
+public:
+    TTSensorHistory() { _initTiers(); }
+
+    /** Replays the log; false until TTStorageTask has mounted LittleFS (call again later). */
+    bool begin();
+    bool isReady() const { return _ready; }
+
+    uint32_t nowMinute() const;
+    void addSample(uint32_t minute, const float values[TT_SENSOR_CHANNEL_COUNT], const bool valid[TT_SENSOR_CHANNEL_COUNT]);
+
+    /** Append dirty buckets to the log if TT_SENSOR_HISTORY_CHECKPOINT_MIN has passed (or force). */
+    bool checkpoint(bool force = false);
+
+    /** Copy the bucket `ago` periods before the current one. Returns false if there is no data. */
+    bool read(TTSensorHistoryTier tier, uint16_t ago, TTSensorHistoryBucket& out) const;
+
+    /**
+     * Copy the avg of `channel` for the last `count` periods, oldest first, into out.
+     * Periods without data are TT_SENSOR_HISTORY_INVALID. Returns the number of valid points.
+     */
+    uint16_t readSeries(TTSensorHistoryTier tier, TTSensorChannelIndex channel, uint16_t count, int16_t* out) const;
+
+    static int16_t toFixed(TTSensorChannelIndex channel, float value);
+    static float toFloat(TTSensorChannelIndex channel, int16_t value);
+
+private:
+    struct Tier {
+        TTSensorHistoryBucket* buckets;
+        uint16_t size;
+        uint16_t periodMinutes;
+        uint8_t* dirty;
+        int32_t sum[TT_SENSOR_CHANNEL_COUNT];
+        uint16_t n[TT_SENSOR_CHANNEL_COUNT];
+        uint32_t openStamp;
+        bool hasOpen;
+    };
+
+    struct Record {
+        uint8_t magic;
+        uint8_t tier;
+        TTSensorHistoryBucket bucket;
+        uint8_t crc;
+    } __attribute__((packed));
+
+    void _initTiers();
+    void _addToTier(Tier& tier, uint32_t minute, const int16_t fixed[TT_SENSOR_CHANNEL_COUNT], const bool valid[TT_SENSOR_CHANNEL_COUNT]);
+    void _placeBucket(Tier& tier, const TTSensorHistoryBucket& bucket);
+    bool _replay();
+    bool _compact();
+    static uint8_t _crc8(const uint8_t* data, size_t len);
+
+    TTSensorHistoryBucket _minutes[TT_SENSOR_HISTORY_MINUTES];
+    TTSensorHistoryBucket _hours[TT_SENSOR_HISTORY_HOURS];
+    TTSensorHistoryBucket _days[TT_SENSOR_HISTORY_DAYS];
+    uint8_t _minutesDirty[TT_SENSOR_HISTORY_MINUTES];
+    uint8_t _hoursDirty[TT_SENSOR_HISTORY_HOURS];
+    uint8_t _daysDirty[TT_SENSOR_HISTORY_DAYS];
+    Tier _tiers[TT_HISTORY_TIER_COUNT];
+
+    uint32_t _minuteBase = 0;
+    uint32_t _lastCheckpointMinute = 0;
+    bool _ready = false;
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -0,0 +1,38 @@
+#include "TTSensorPipeline.h"
+#include <algorithm>
+#include <math.h>
+
+void TTSensorChannel::addSample(float value) {
+    if (_burstCount >= TT_SENSOR_MAX_OVERSAMPLE) return;
+    if (isnan(value)) return;
+    _burst[_burstCount++] = value;
+}
+
+bool TTSensorChannel::endBurst() {
+    if (_burstCount == 0) return false;
+
+    if (_mode == TT_SENSOR_FILTER_MEDIAN) {
+        std::sort(_burst, _burst + _burstCount);
+        uint8_t mid = _burstCount / 2;
+        _value = (_burstCount % 2) ? _burst[mid] : (_burst[mid - 1] + _burst[mid]) * 0.5f;
+    } else {
+        float sum = 0.0f;
+        for (uint8_t i = 0; i < _burstCount; i++) sum += _burst[i];
+        float mean = sum / _burstCount;
+        _value = _hasValue ? _value + _emaAlpha * (mean - _value) : mean;
+    }
+    _hasValue = true;
+    return true;
+}
+
+bool TTSensorChannel::changedSincePublished() const {
+    if (!_hasValue) return false;
+    if (!_hasPublished) return true;
+    return fabsf(_value - _published) > _deadBand;
+}
+
+void TTSensorChannel::markPublished() {
+    if (!_hasValue) return;
+    _published = _value;
+    _hasPublished = true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#define TT_SENSOR_MAX_OVERSAMPLE  16
+// A channel has changed once it moved this many steps from the published value; above 0.5 so a value
+// hovering on a rounding boundary (22.05 -> 22.04 -> 22.06) does not flip the display back and forth
+#define TT_SENSOR_DEAD_BAND_STEPS  0.75f
+
+enum TTSensorFilterMode {
+    TT_SENSOR_FILTER_MEDIAN = 0,    // Median of each oversampling burst (rejects single-sample spikes)
+    TT_SENSOR_FILTER_EMA            // Burst mean, smoothed across bursts with an exponential moving average
+};
+
+/**
+ * One sensor channel of the sampling pipeline: collects an N-sample burst, reduces it with the
+ * configured filter, and reports whether the result moved more than TT_SENSOR_DEAD_BAND_STEPS of
+ * `step` (the display resolution) away from the last published value.
+ */
+class TTSensorChannel {
+public:
+    TTSensorChannel(float step, TTSensorFilterMode mode, float emaAlpha)
+        : _deadBand(TT_SENSOR_DEAD_BAND_STEPS * step), _mode(mode), _emaAlpha(emaAlpha) {}
+
+    void beginBurst() { _burstCount = 0; }
+    void addSample(float value);
+    /** Reduce the current burst into value(). Returns false if the burst had no samples. */
+    bool endBurst();
+
+    bool hasValue() const { return _hasValue; }
+    float value() const { return _value; }
+
+    bool changedSincePublished() const;
+    void markPublished();
+
+private:
+    float _burst[TT_SENSOR_MAX_OVERSAMPLE];
+    uint8_t _burstCount = 0;
+    float _value = 0.0f;
+    bool _hasValue = false;
+    float _published = 0.0f;
+    bool _hasPublished = false;
+
+    float _deadBand;
+    TTSensorFilterMode _mode;
+    float _emaAlpha;
+};
@@ -1,18 +1,23 @@
+#define TT_LOG_MODULE SENSOR
+
 #include "TTSensorTask.h"
 #include <Wire.h>
 #include "../Base/Logger.h"
 #include "../Base/TTInstance.h"
 #include "../Base/TTNotificationPayloads.h"
-#include "TTUITask.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
 void TTSensorTask::setup() {
+    // Only the newest reading matters; a slow UI must never build a backlog of sensor updates
+    TTInstanceOf<TTNotificationCenter>().setLatestOnly(TT_NOTIFICATION_SENSOR_DATA_UPDATE);
+
     LOG_I("Initializing I2C (SDA=%d, SCL=%d)...", TT_SENSOR_I2C_SDA, TT_SENSOR_I2C_SCL);
     Wire.begin(TT_SENSOR_I2C_SDA, TT_SENSOR_I2C_SCL);
 
     LOG_I("Initializing AHT20 sensor...");
-    if (_aht20.begin()) {
+    _aht20Ok = _aht20.begin();
+    if (_aht20Ok) {
         LOG_I("AHT20 sensor initialized");
     } else {
         LOG_W("AHT20 sensor not found! Check wiring.");
@@ -21,40 +26,85 @@ void TTSensorTask::setup() {
     LOG_I("Initializing BMP280 sensor...");
     _bmp280Ok = _bmp280.begin(BMP280_ADDRESS);
     if (_bmp280Ok) {
-        LOG_I("BMP280 sensor initialized");
+        // Forced mode: the sensor sleeps between our bursts; oversampling and the IIR filter are
+        // kept low because the pipeline already oversamples and filters on the host side.
+        _bmp280.setSampling(Adafruit_BMP280::MODE_FORCED,
+                            Adafruit_BMP280::SAMPLING_X1,    // temperature
+                            Adafruit_BMP280::SAMPLING_X4,    // pressure
+                            Adafruit_BMP280::FILTER_OFF,
+                            Adafruit_BMP280::STANDBY_MS_1);
+        LOG_I("BMP280 sensor initialized (forced mode)");
     } else {
         LOG_W("BMP280 sensor not found! Check wiring or I2C address.");
     }
 
+    _history.begin();   // May run before TTStorageTask mounted LittleFS; performSensorRead() retries
+
     runRepeat(TT_SENSOR_UPDATE_INTERVAL * 1000, [this]() {
-        performSensorRead();
+        performSensorRead(false);
     });
 }
 
-void TTSensorTask::performSensorRead() {
-    float temperature = 0.0f;
-    float humidity = 0.0f;
-    float pressure = 0.0f;
+void TTSensorTask::performSensorRead(bool forcePublish) {
+    _temperature.beginBurst();
+    _humidity.beginBurst();
+    _pressure.beginBurst();
 
-    sensors_event_t humidityEvent, tempEvent;
-    if (_aht20.getEvent(&humidityEvent, &tempEvent)) {
-        temperature = tempEvent.temperature;
-        humidity = humidityEvent.relative_humidity;
-        LOG_I("AHT20: Temperature=%.1f°C, Humidity=%.1f%%", temperature, humidity);
+    for (uint8_t i = 0; i < TT_SENSOR_OVERSAMPLE_COUNT; i++) {
+        if (i > 0) vTaskDelay(pdMS_TO_TICKS(TT_SENSOR_SAMPLE_SPACING_MS));
+
+        sensors_event_t humidityEvent, tempEvent;
+        if (_aht20Ok && _aht20.getEvent(&humidityEvent, &tempEvent)) {
+            _temperature.addSample(tempEvent.temperature);
+            _humidity.addSample(humidityEvent.relative_humidity);
+        }
+        if (_bmp280Ok && _bmp280.takeForcedMeasurement()) {
+            _pressure.addSample(_bmp280.readPressure() / 100.0f);  // Pa to hPa
+        }
     }
 
-    if (_bmp280Ok) {
-        pressure = _bmp280.readPressure() / 100.0f;  // Pa to hPa
-        LOG_I("BMP280: Pressure=%.1f hPa", pressure);
+    // Only fresh bursts go into history; a stale value from an earlier burst would flatten the series
+    bool valid[TT_SENSOR_CHANNEL_COUNT] = { _temperature.endBurst(), _humidity.endBurst(), _pressure.endBurst() };
+
+    float temperature = _temperature.hasValue() ? _temperature.value() : 0.0f;
+    float humidity = _humidity.hasValue() ? _humidity.value() : 0.0f;
+    float pressure = _pressure.hasValue() ? _pressure.value() : 0.0f;
+    LOG_I("Sensors (x%d): Temperature=%.2f°C, Humidity=%.2f%%, Pressure=%.2f hPa",
+          TT_SENSOR_OVERSAMPLE_COUNT, temperature, humidity, pressure);
+
+    float values[TT_SENSOR_CHANNEL_COUNT] = { temperature, humidity, pressure };
+    // History starts once TTStorageTask has mounted LittleFS; earlier readings are only published
+    if (_history.begin()) {
+        _history.addSample(_history.nowMinute(), values, valid);
+        _history.checkpoint();
+    }
+
+    bool changed = _temperature.changedSincePublished() ||
+                   _humidity.changedSincePublished() ||
+                   _pressure.changedSincePublished();
+    if (!changed && !forcePublish) {
+        _skippedPublishes++;
+        LOG_D("Sensors: within dead band, not published (%u skipped)", (unsigned)_skippedPublishes);
+        return;
+    }
+    // History is sampled every minute, the display keeps the slower baseline cadence
+    uint32_t now = millis();
+    if (!forcePublish && _hasPublished && now - _lastPublishMs < TT_SENSOR_PUBLISH_INTERVAL * 1000UL) {
+        return;
     }
+    _hasPublished = true;
+    _lastPublishMs = now;
+    _temperature.markPublished();
+    _humidity.markPublished();
+    _pressure.markPublished();
 
     TTSensorDataPayload payload = { temperature, humidity, pressure };
-    TTInstanceOf<TTUITask>().postNotification(TT_NOTIFICATION_SENSOR_DATA_UPDATE, payload);
+    TTInstanceOf<TTNotificationCenter>().post(TT_NOTIFICATION_SENSOR_DATA_UPDATE, payload);
 }
 
 void TTSensorTask::requestSensorUpdateAsync() {
     auto* f = new std::function<void()>([this]() {
-        performSensorRead();
+        performSensorRead(true);
     });
     enqueue(f);
 }
@@ -4,25 +4,59 @@
 #include <Adafruit_AHTX0.h>
 #include <Adafruit_BMP280.h>
 #include "../Base/TTVTask.h"
+#include "TTSensorPipeline.h"
+#include "TTSensorHistory.h"
 
 #define TT_SENSOR_I2C_SDA   23
 #define TT_SENSOR_I2C_SCL   22
-#define TT_SENSOR_UPDATE_INTERVAL  10 * 60
+#define TT_SENSOR_UPDATE_INTERVAL  60        // Seconds; one history sample per minute
+#define TT_SENSOR_PUBLISH_INTERVAL  10 * 60  // Seconds; changed readings are published at most this often
+
+// Sampling pipeline: N samples per update, reduced by TT_SENSOR_FILTER_MODE
+#define TT_SENSOR_OVERSAMPLE_COUNT     5
+#define TT_SENSOR_SAMPLE_SPACING_MS    20
+#define TT_SENSOR_FILTER_MODE          TT_SENSOR_FILTER_MEDIAN
+#define TT_SENSOR_EMA_ALPHA            0.3f
+
+// Publish steps, matching the display precision in TTClockScreenPage (%.1f, %.1f, %.0f): a reading is
+// published when it moved more than TT_SENSOR_DEAD_BAND_STEPS of its step
+#define TT_SENSOR_TEMP_THRESHOLD       0.1f
+#define TT_SENSOR_HUMIDITY_THRESHOLD   0.1f
+#define TT_SENSOR_PRESSURE_THRESHOLD   1.0f
+
+static_assert(TT_SENSOR_OVERSAMPLE_COUNT <= TT_SENSOR_MAX_OVERSAMPLE, "TT_SENSOR_OVERSAMPLE_COUNT too large");
 
 class TTSensorTask : public TTVTask {
 public:
-    TTSensorTask() : TTVTask("TTSensorTask", 4096) {}
+    TTSensorTask() : TTVTask("TTSensorTask", 6144),
+        _temperature(TT_SENSOR_TEMP_THRESHOLD, TT_SENSOR_FILTER_MODE, TT_SENSOR_EMA_ALPHA),
+        _humidity(TT_SENSOR_HUMIDITY_THRESHOLD, TT_SENSOR_FILTER_MODE, TT_SENSOR_EMA_ALPHA),
+        _pressure(TT_SENSOR_PRESSURE_THRESHOLD, TT_SENSOR_FILTER_MODE, TT_SENSOR_EMA_ALPHA) {}
 
+    /** Take a reading now and publish it even if it did not change (e.g. a page just appeared). */
     void requestSensorUpdateAsync();
 
+    /** Minute / hourly / daily rollups; the read functions are safe from any task. */
+    const TTSensorHistory& history() const { return _history; }
+
 protected:
     void setup() override;
     void loop() override;
 
 private:
-    void performSensorRead();
+    void performSensorRead(bool forcePublish);
 
     Adafruit_AHTX0 _aht20;
     Adafruit_BMP280 _bmp280;
+    bool _aht20Ok = false;
     bool _bmp280Ok = false;
+
+    TTSensorChannel _temperature;
+    TTSensorChannel _humidity;
+    TTSensorChannel _pressure;
+    uint32_t _skippedPublishes = 0;
+    bool _hasPublished = false;
+    uint32_t _lastPublishMs = 0;
+
+    TTSensorHistory _history;
 };
@@ -0,0 +1,27 @@
+#define TT_LOG_MODULE STORAGE
+
+#include "TTStorageTask.h"
+#include "../Base/Logger.h"
+#include "../Base/TTInstance.h"
+#include "../Base/TTPreference.h"
+#include "../Base/TTStorage.h"
+#include "../Base/TTNvsPreference.h"
+
+void TTStorageTask::setup() {
+    if (!TTStorage::mount()) {
+        LOG_E("Storage task: LittleFS mount failed");
+    }
+    // Typed settings live in NVS and load lazily per key; the JSON store is only read on first use
+    // (or once, to migrate registered keys into NVS)
+    TTInstanceOf<TTPreference>().attachWriter(this);
+    TTInstanceOf<TTNvsPreference>().attachWriter(this);
+    if (!TTInstanceOf<TTNvsPreference>().begin()) {
+        LOG_E("Storage task: NVS preference init failed");
+    }
+    LOG_I("Storage task started.");
+}
+
+void TTStorageTask::loop() {
+    TTInstanceOf<TTPreference>().flushIfDue();
+    TTInstanceOf<TTNvsPreference>().flushIfDue();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../Base/TTVTask.h"
+
+// Woken on every preference change (JSON or NVS); the timeout only re-checks the debounce window
+#define TT_STORAGE_LOOP_DELAY_MS  250
+
+/** Background LittleFS writer: mounts LittleFS and owns deferred persistence so UI / sensor tasks never block on flash. */
+class TTStorageTask : public TTVTask {
+public:
+    TTStorageTask() : TTVTask("TTStorageTask", 6144) {}
+
+protected:
+    void setup() override;
+    void loop() override;
+};
@@ -1,14 +1,20 @@
+#define TT_LOG_MODULE UI
+
 #include "TTUITask.h"
 #include "../Pages/TTHomePage.h"
 #include <SPI.h>
 #include <LittleFS.h>
 #include <memory>
+#include <string>
 #include "../Base/TTLvglEpdDriver.h"
 #include "../Base/TTInstance.h"
 #include "../Base/TTPopupLayer.h"
 #include "../Base/Logger.h"
 #include "../Base/ErrorCheck.h"
 #include "../Base/TTFontManager.h"
+#include "../Base/TTStorage.h"
+#include "TTLogTask.h"
+#include "TTPanelTask.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
@@ -17,19 +23,44 @@ void TTUITask::setup() {
     SPI.begin(TT_UI_EPD_SCK, -1, TT_UI_EPD_MOSI, TT_UI_EPD_CS);
 
     LOG_I("Initializing E-Paper display...");
-    _display.init(115200, true, 2, false, SPI, SPISettings(4000000, MSBFIRST, SPI_MODE0));
+    // With a record of the frame on the glass, the first refresh need not be GxEPD2's initial full one
+    bool retained = TTInstanceOf<TTLvglEpdDriver>().restoreFrameRecord();
+    _display.init(115200, !retained, 2, false, SPI, SPISettings(4000000, MSBFIRST, SPI_MODE0));
 
-    ERR_CHECK_FAIL(LittleFS.begin());
-    LOG_I("LittleFS initialized");
+    // Fonts are needed before TTStorageTask may have run; mount() is shared and happens once
+    ERR_CHECK_FAIL(TTStorage::mount());
 
     ERR_CHECK_FAIL(TTFontManager::instance().begin());
 
     LOG_I("Initializing LVGL...");
     ERR_CHECK_FAIL(TTInstanceOf<TTLvglEpdDriver>().begin(_display));
     TTInstanceOf<TTPopupLayer>().begin(TTInstanceOf<TTLvglEpdDriver>().getDisplay());
+#if TT_EPD_PIPELINE
+    TTInstanceOf<TTPanelTask>().start(TT_PANEL_TASK_CORE, TT_PANEL_LOOP_DELAY_MS, TT_PANEL_TASK_PRIORITY);
+#endif
+
+    // The console runs on TTLogTask; the counters belong to the tasks that record them, so the work is posted there
+    TTInstanceOf<TTLogTask>().addCommand("metrics", "refresh timing per phase ('metrics reset' clears)", [this](const char* args) {
+        bool reset = strcmp(args, "reset") == 0;
+        enqueue(new std::function<void()>([reset]() { _metricsCommand(reset); }));
+    });
+    TTInstanceOf<TTLogTask>().addCommand("toast", "show TEXT as a toast on the popup layer", [this](const char* args) {
+        std::string text(args);
+        enqueue(new std::function<void()>([text]() { TTInstanceOf<TTPopupLayer>().showToast(text.c_str()); }));
+    });
+    TTInstanceOf<TTLogTask>().addCommand("clean", "clean the window X1 Y1 X2 Y2 of the panel", [this](const char* args) {
+        int x1, y1, x2, y2;
+        if (sscanf(args, "%d %d %d %d", &x1, &y1, &x2, &y2) != 4 || x1 < 0 || y1 < 0 || x2 < x1 || y2 < y1 ||
+            x2 >= EPD_WIDTH || y2 >= EPD_HEIGHT) {
+            LOG_W("Usage: clean X1 Y1 X2 Y2 (within %dx%d)", EPD_WIDTH, EPD_HEIGHT);
+            return;
+        }
+        lv_area_t area = {x1, y1, x2, y2};
+        enqueue(new std::function<void()>([area]() { TTInstanceOf<TTLvglEpdDriver>().cleanArea(area); }));
+    });
 
     lv_display_t* disp = TTInstanceOf<TTLvglEpdDriver>().getDisplay();
-    ERR_CHECK_FAIL(_keypad.begin(disp));
+    ERR_CHECK_FAIL(_keypad.begin(disp, this));
     _nav.setKeypadInput(&_keypad);
     _keypad.setNavigationController(&_nav);
     TTInstanceOf<TTPopupLayer>().setKeypadInput(&_keypad);
@@ -39,14 +70,24 @@ void TTUITask::setup() {
     LOG_I("UI task started.");
 }
 
-void TTUITask::requestDeepRefreshAsync() {
-    auto* f = new std::function<void()>([]() {
-        TTInstanceOf<TTLvglEpdDriver>().requestRefresh(TT_REFRESH_DEEP);
-    });
-    enqueue(f);
+void TTUITask::_metricsCommand(bool reset) {
+    TTLvglEpdDriver& driver = TTInstanceOf<TTLvglEpdDriver>();
+    if (reset) {
+        driver.metrics().reset();
+        driver.frames().reset();
+        driver.fastRegions().reset();
+        LOG_I("Refresh metrics reset");
+    } else {
+        driver.metrics().report();
+        driver.frames().report();
+        driver.fastRegions().report();
+    }
 }
 
 void TTUITask::loop() {
     _keypad.tick();
     lv_timer_handler();
+    TTInstanceOf<TTPopupLayer>().commit();
+    _nav.idle();
+    TTInstanceOf<TTLvglEpdDriver>().commitFrame();
 }
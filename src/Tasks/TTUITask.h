@@ -7,7 +7,8 @@
 #include "../Base/TTNavigationController.h"
 #include "../Base/TTKeypadInput.h"
 
-#define TT_UI_LOOP_DELAY_MS  5
+// Keypad ISRs wake the UI task, so the loop only needs to keep up with LVGL timers
+#define TT_UI_LOOP_DELAY_MS  30
 
 #define TT_UI_EPD_MOSI  4
 #define TT_UI_EPD_SCK   16
@@ -21,13 +22,14 @@ public:
     TTUITask() : TTVTask("TTUITask", 8192),
         _display(EPD_DRIVER_CLASS(TT_UI_EPD_CS, TT_UI_EPD_DC, TT_UI_EPD_RST, TT_UI_EPD_BUSY)) {}
 
-    void requestDeepRefreshAsync();
-
 protected:
     void setup() override;
     void loop() override;
 
 private:
+    /** Serial "metrics", posted to the UI task that updates the frame and fast region counters. */
+    static void _metricsCommand(bool reset);
+
     EPaperDisplay _display;
     TTNavigationController _nav;
     TTKeypadInput _keypad;
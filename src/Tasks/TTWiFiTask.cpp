@@ -1,3 +1,5 @@
+#define TT_LOG_MODULE WIFI
+
 #include "TTWiFiTask.h"
 #include "../Base/Logger.h"
 
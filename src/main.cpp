@@ -28,6 +28,8 @@
 #include "Base/Util.h"
 #include "Tasks/TTUITask.h"
 #include "Tasks/TTSensorTask.h"
+#include "Tasks/TTStorageTask.h"
+#include "Tasks/TTLogTask.h"
 
 void setup() {
     _logger.setLevel(LOG_LEVEL_DEBUG);
@@ -41,8 +43,10 @@ void setup() {
     Util::printChipInfo();
     delay(200);
 
+    TTInstanceOf<TTLogTask>().start(1, TT_LOG_LOOP_DELAY_MS, TT_LOG_TASK_PRIORITY);
     TTInstanceOf<TTUITask>().start(0, TT_UI_LOOP_DELAY_MS);
     TTInstanceOf<TTSensorTask>().start(1);
+    TTInstanceOf<TTStorageTask>().start(1, TT_STORAGE_LOOP_DELAY_MS);
 }
 
 void loop() {
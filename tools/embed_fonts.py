@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""
+Embedded Font Generator
+Turns selected ranges of the LVGL .bin fonts in data/fonts into constexpr C++ tables
+(src/Base/TTEmbeddedFontData.cpp). TTFontLoader serves those codepoints from flash
+rodata; everything else is still read from LittleFS.
+
+Re-run after regenerating the .bin fonts:
+  python tools/embed_fonts.py
+"""
+
+import struct
+import sys
+from pathlib import Path
+
+
+# (font size, font file, codepoints) - keep to glyphs drawn on every screen
+EMBEDDED_FONTS = [
+    (12, "data/fonts/all_12.bin", [chr(c) for c in range(0x20, 0x7F)]),  # UI text, ASCII
+    (48, "data/fonts/en_48.bin", list("0123456789:.- ")),                 # Clock numerals
+]
+
+OUTPUT = "src/Base/TTEmbeddedFontData.cpp"
+
+
+def read_table(f, tag):
+    """Find a table by tag name; returns its start offset or None"""
+    f.seek(0)
+    while True:
+        pos = f.tell()
+        data = f.read(8)
+        if len(data) < 8:
+            return None
+        length = struct.unpack('<I', data[:4])[0]
+        name = data[4:8].decode('ascii', errors='ignore')
+        if name == tag:
+            return pos
+        f.seek(pos + length)
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def bits(self, n):
+        result = 0
+        for _ in range(n):
+            byte = self.data[self.pos // 8] if self.pos // 8 < len(self.data) else 0
+            result = (result << 1) | ((byte >> (7 - self.pos % 8)) & 1)
+            self.pos += 1
+        return result
+
+    def signed(self, n):
+        if n == 0:
+            return 0
+        val = self.bits(n)
+        return val - (1 << n) if val & (1 << (n - 1)) else val
+
+
+class LvglBinFont:
+    """Reads glyphs the same way TTFontLoader does"""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            self.raw = f.read()
+            head = read_table(f, 'head') + 8
+            self.cmap = read_table(f, 'cmap')
+            self.loca = read_table(f, 'loca')
+            self.glyf = read_table(f, 'glyf')
+
+        self.ascent, self.descent = struct.unpack_from('<Hh', self.raw, head + 8)
+        self.def_adv_w = struct.unpack_from('<H', self.raw, head + 22)[0]
+        self.loc_format = self.raw[head + 26]
+        (self.adv_format, self.bpp, self.bits_x_y,
+         self.bits_w_h, self.bits_adv) = self.raw[head + 28:head + 33]
+
+    def glyph_id(self, unicode):
+        count = struct.unpack_from('<I', self.raw, self.cmap + 8)[0]
+        for i in range(count):
+            (data_offset, start, length, gid_offset, entries, cmap_type) = struct.unpack_from(
+                '<IIHHHB', self.raw, self.cmap + 12 + i * 16)
+            if not start <= unicode < start + length:
+                continue
+            offset = unicode - start
+            base = self.cmap + data_offset
+            if cmap_type == 2:
+                return gid_offset + offset
+            if cmap_type == 0:
+                return gid_offset + self.raw[base + offset]
+            for j in range(entries):
+                if struct.unpack_from('<H', self.raw, base + j * 2)[0] == offset:
+                    if cmap_type == 3:
+                        return gid_offset + j
+                    return struct.unpack_from('<H', self.raw, base + entries * 2 + j * 2)[0]
+        return 0
+
+    def glyph(self, unicode):
+        """(adv_w, box_w, box_h, ofs_x, ofs_y, A8 bytes) or None"""
+        gid = self.glyph_id(unicode)
+        if gid == 0:
+            return None
+        if self.loc_format == 0:
+            offset = struct.unpack_from('<H', self.raw, self.loca + 12 + gid * 2)[0]
+        else:
+            offset = struct.unpack_from('<I', self.raw, self.loca + 12 + gid * 4)[0]
+
+        r = BitReader(self.raw[self.glyf + offset:])
+        if self.bits_adv > 0:
+            adv_w = r.bits(self.bits_adv)
+            if self.adv_format == 1:
+                adv_w = (adv_w + 8) >> 4
+        else:
+            adv_w = self.def_adv_w
+        ofs_x = r.signed(self.bits_x_y)
+        ofs_y = r.signed(self.bits_x_y)
+        box_w = r.bits(self.bits_w_h)
+        box_h = r.bits(self.bits_w_h)
+        a8 = bytes(0xFF if r.bits(self.bpp) else 0x00 for _ in range(box_w * box_h))
+        return adv_w, box_w, box_h, ofs_x, ofs_y, a8
+
+
+def format_bytes(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ", ".join(f"0x{b:02X}" for b in data[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def generate(root):
+    out = []
+    out.append("// Generated by tools/embed_fonts.py from data/fonts - do not edit.")
+    out.append("")
+    out.append('#include "TTEmbeddedFont.h"')
+    out.append("")
+
+    entries = []
+    for size, path, chars in EMBEDDED_FONTS:
+        font = LvglBinFont(root / path)
+        glyphs = []
+        bitmap = bytearray()
+        for cp in sorted(set(ord(c) for c in chars)):
+            g = font.glyph(cp)
+            if g is None:
+                print(f"  {path}: U+{cp:04X} not in font, skipped")
+                continue
+            adv_w, box_w, box_h, ofs_x, ofs_y, a8 = g
+            if box_w > 255 or box_h > 255 or not -128 <= ofs_x <= 127 or not -128 <= ofs_y <= 127:
+                raise ValueError(f"{path}: U+{cp:04X} does not fit TTEmbeddedGlyph")
+            glyphs.append((cp, adv_w, box_w, box_h, ofs_x, ofs_y, len(bitmap)))
+            bitmap += a8
+        print(f"  {size}px: {len(glyphs)} glyphs, {len(bitmap)} bitmap bytes ({path})")
+
+        out.append(f"// {Path(path).name}: {len(glyphs)} glyphs")
+        out.append(f"static constexpr uint8_t BITMAP_{size}[] = {{")
+        out.append(format_bytes(bitmap) if bitmap else "    0x00,")
+        out.append("};")
+        out.append("")
+        out.append(f"static constexpr TTEmbeddedGlyph GLYPHS_{size}[] = {{")
+        for cp, adv_w, box_w, box_h, ofs_x, ofs_y, offset in glyphs:
+            label = chr(cp) if 0x20 < cp < 0x7F and chr(cp) not in "\\'" else f"U+{cp:04X}"
+            out.append(f"    {{ 0x{cp:04X}, {adv_w}, {box_w}, {box_h}, {ofs_x}, {ofs_y}, {offset} }},  // {label}")
+        out.append("};")
+        out.append("")
+        entries.append((size, font.ascent, font.descent))
+
+    out.append("static constexpr TTEmbeddedFont FONTS[] = {")
+    for size, ascent, descent in entries:
+        out.append(f"    {{ {size}, {ascent}, {descent}, GLYPHS_{size}, "
+                   f"sizeof(GLYPHS_{size}) / sizeof(GLYPHS_{size}[0]), BITMAP_{size} }},")
+    out.append("};")
+    out.append("")
+    out.append("const TTEmbeddedFont* TTEmbeddedFont_find(int size) {")
+    out.append("    for (const TTEmbeddedFont& font : FONTS) {")
+    out.append("        if (font.size == size) return &font;")
+    out.append("    }")
+    out.append("    return nullptr;")
+    out.append("}")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    root = Path(__file__).parent.parent
+    for _, path, _ in EMBEDDED_FONTS:
+        if not (root / path).exists():
+            print(f"Error: Font file not found: {path}")
+            sys.exit(1)
+
+    print("Embedding fonts...")
+    source = generate(root)
+    (root / OUTPUT).write_text(source)
+    print(f"Done! Wrote {OUTPUT}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+Binary Log Decoder
+Restores text from firmware built with -D TT_LOG_BINARY=1 (see src/Base/Logger.h).
+
+Frames carry FNV-1a hashes of the format string and of the source file name; the format strings are
+recovered by scanning the sources for LOG_x(...) / TT_LOG_FORMAT_ID(...) calls. Bytes outside frames
+(ROM boot messages, library prints) are passed through unchanged.
+
+Usage:
+    python tools/log_decode.py capture.bin             # decode a file ('-' for stdin)
+    python tools/log_decode.py --port /dev/ttyUSB0     # live from the serial port (needs pyserial)
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+from pathlib import Path
+
+SYNC = b'\xA5\x5A'
+HEADER = struct.Struct('<BBBHIII')      # level, argc, used, line, timeMs, fileId, fmtId
+ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_STRING, ARG_POINTER = range(5)
+POINTER_SIZE = 4                        # ESP32
+MAX_ARGS = 8
+RECORD_DATA = 84
+
+LEVEL_TAGS = ['', '[E]', '[W]', '[I]', '[D]', '[V]']
+LEVEL_COLORS = ['', '\033[31m', '\033[35m', '\033[32m', '\033[34m', '']
+
+# Format macros spliced into literals (ESP32 Arduino: int32_t is int)
+KNOWN_MACROS = {
+    'LV_PRId32': 'd', 'LV_PRIu32': 'u', 'LV_PRIx32': 'x', 'LV_PRIX32': 'X',
+    'PRId32': 'd', 'PRIu32': 'u', 'PRIx32': 'x', 'PRIX32': 'X',
+    'PRId64': 'lld', 'PRIu64': 'llu', 'PRIx64': 'llx',
+}
+
+SOURCE_SUFFIXES = ('.c', '.cpp', '.h', '.hpp')
+CALL_RE = re.compile(r'\b(?:LOG_[EWIDV]|TT_LOG_FORMAT_ID)\s*\(')
+DEFINE_RE = re.compile(r'^\s*#\s*define\s+(\w+)\s+("(?:[^"\\]|\\.)*")\s*$', re.M)
+TOKEN_RE = re.compile(r'\s*(?:"((?:[^"\\]|\\.)*)"|([A-Za-z_]\w*)|//[^\n]*|/\*.*?\*/|\\\n)', re.S)
+
+
+def fnv1a(data):
+    """Same as ttLogHash() in Logger.h"""
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def unescape(literal):
+    """Decode C escapes of a string literal body into bytes"""
+    out = bytearray()
+    i = 0
+    while i < len(literal):
+        c = literal[i]
+        if c != '\\':
+            out += c.encode('utf-8')
+            i += 1
+            continue
+        i += 1
+        c = literal[i]
+        simple = {'n': 10, 't': 9, 'r': 13, '0': 0, 'a': 7, 'b': 8, 'f': 12, 'v': 11,
+                  '\\': 92, '"': 34, "'": 39, '?': 63}
+        if c == 'x':
+            m = re.match(r'[0-9a-fA-F]+', literal[i + 1:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif c in '01234567':
+            m = re.match(r'[0-7]{1,3}', literal[i:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += len(m.group(0))
+        else:
+            out.append(simple.get(c, ord(c)))
+            i += 1
+    return bytes(out)
+
+
+def parse_format(text, pos, macros):
+    """Concatenate the literals / known macros of the first call argument starting at pos"""
+    parts = []
+    while True:
+        m = TOKEN_RE.match(text, pos)
+        if not m:
+            break
+        pos = m.end()
+        if m.group(1) is not None:
+            parts.append(unescape(m.group(1)))
+        elif m.group(2) is not None:
+            name = m.group(2)
+            if name in macros:
+                parts.append(macros[name])
+            else:
+                return None     # Not a literal format (e.g. the macro parameter inside Logger.h)
+    if not parts:
+        return None
+    return b''.join(parts)
+
+
+def build_dictionary(roots):
+    """Map fmtId -> [(file, line, fmt)] and fileId -> file name"""
+    files = []
+    for root in roots:
+        for dirpath, _, names in os.walk(root):
+            files += [Path(dirpath) / n for n in names if n.endswith(SOURCE_SUFFIXES)]
+
+    macros = {k: v.encode() for k, v in KNOWN_MACROS.items()}
+    texts = {}
+    for path in files:
+        text = path.read_text(encoding='utf-8', errors='replace')
+        texts[path] = text
+        for name, literal in DEFINE_RE.findall(text):
+            macros[name] = unescape(literal[1:-1])
+
+    formats = {}
+    names = {}
+    for path, text in texts.items():
+        names[fnv1a(path.name.encode())] = path.name
+        for m in CALL_RE.finditer(text):
+            fmt = parse_format(text, m.end(), macros)
+            if fmt is None:
+                continue
+            line = text.count('\n', 0, m.start()) + 1
+            formats.setdefault(fnv1a(fmt), []).append((path.name, line, fmt.decode('utf-8', 'replace')))
+    return formats, names
+
+
+def c_format(fmt, args):
+    """printf() with captured (type, value) arguments, following Logger::_formatMessage"""
+    out = []
+    i = 0
+    arg = 0
+    spec_re = re.compile(r'%([-+ #0]*)(\*|\d*)(?:\.(\*|\d*))?(hh|h|ll|l|L|z|j|t)?([diouxXeEfFgGaAcsp%])')
+    while i < len(fmt):
+        m = spec_re.match(fmt, i) if fmt[i] == '%' else None
+        if not m:
+            out.append(fmt[i])
+            i += 1
+            continue
+        i = m.end()
+        flags, width, precision, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        # '*' width / precision take the next integer argument, as in Logger::_formatMessage
+        if width == '*':
+            width = str(args[arg][1]) if arg < len(args) and args[arg][0] in (ARG_INT, ARG_UINT) else ''
+            arg += 1 if width else 0
+        if precision == '*':
+            precision = str(args[arg][1]) if arg < len(args) and args[arg][0] in (ARG_INT, ARG_UINT) else None
+            arg += 1 if precision is not None else 0
+        if arg >= len(args):
+            out.append('?')
+            continue
+        kind, value = args[arg]
+        arg += 1
+        spec = '%' + flags + width + ('.' + precision if precision is not None else '')
+        if kind in (ARG_INT, ARG_UINT) and conv in 'dicuxXo':
+            if length not in ('ll', 'j'):
+                value &= 0xFFFFFFFF     # int / long / size_t are 32-bit on ESP32
+                if conv in 'di' and value & 0x80000000:
+                    value -= 1 << 32
+            elif conv not in 'di' and value < 0:
+                value &= 0xFFFFFFFFFFFFFFFF
+            out.append((spec + ('d' if conv in 'iu' else conv)) % value if conv != 'c' else chr(value & 0xFF))
+        elif kind == ARG_DOUBLE and conv in 'fFeEgGaA':
+            out.append((spec + ('f' if conv in 'aA' else conv)) % value)
+        elif kind == ARG_STRING and conv == 's':
+            out.append((spec + 's') % value)
+        elif kind == ARG_POINTER and conv == 'p':
+            out.append('0x%x' % value)
+        else:
+            out.append('?')
+    return ''.join(out)
+
+
+def decode_args(types, data):
+    args = []
+    off = 0
+    for t in types:
+        if t in (ARG_INT, ARG_UINT):
+            args.append((t, struct.unpack_from('<q' if t == ARG_INT else '<Q', data, off)[0]))
+            off += 8
+        elif t == ARG_DOUBLE:
+            args.append((t, struct.unpack_from('<d', data, off)[0]))
+            off += 8
+        elif t == ARG_POINTER:
+            args.append((t, struct.unpack_from('<I', data, off)[0]))
+            off += POINTER_SIZE
+        else:
+            n = data[off] if off < len(data) else 0
+            args.append((t, data[off + 1:off + 1 + n].decode('utf-8', 'replace')))
+            off += n + 1 if off < len(data) else 0
+    return args
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Decoder:
+    def __init__(self, formats, names, color):
+        self.formats = formats
+        self.names = names
+        self.color = color
+        self.buf = bytearray()
+
+    def feed(self, chunk):
+        """Returns decoded text for everything complete in the buffer"""
+        self.buf += chunk
+        out = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                # Keep a trailing 0xA5 that may start the next frame
+                keep = 1 if self.buf.endswith(SYNC[:1]) else 0
+                out.append(self.buf[:len(self.buf) - keep].decode('utf-8', 'replace'))
+                del self.buf[:len(self.buf) - keep]
+                break
+            out.append(self.buf[:start].decode('utf-8', 'replace'))
+            del self.buf[:start]
+            frame = self._frame()
+            if frame is None:
+                break               # Incomplete, wait for more bytes
+            if frame is False:
+                out.append(self.buf[:1].decode('latin-1'))
+                del self.buf[:1]    # Not a frame: resync on the next byte
+                continue
+            out.append(frame)
+        return ''.join(out)
+
+    def _frame(self):
+        if len(self.buf) < 2 + HEADER.size:
+            return None
+        level, argc, used, line, time_ms, file_id, fmt_id = HEADER.unpack_from(self.buf, 2)
+        if level > 5 or argc > MAX_ARGS or used > RECORD_DATA:
+            return False
+        type_bytes = (argc + 1) // 2
+        size = 2 + HEADER.size + type_bytes + used + 1
+        if len(self.buf) < size:
+            return None
+        if crc8(self.buf[2:size - 1]) != self.buf[size - 1]:
+            return False
+        body = bytes(self.buf[2 + HEADER.size:size - 1])
+        del self.buf[:size]
+
+        types = [(body[i // 2] >> (4 * (i % 2))) & 0x0F for i in range(argc)]
+        args = decode_args(types, body[type_bytes:])
+        file_name = self.names.get(file_id, '%08x' % file_id)
+        candidates = self.formats.get(fmt_id)
+        if candidates:
+            same_file = [c for c in candidates if c[0] == file_name] or candidates
+            fmt = min(same_file, key=lambda c: abs(c[1] - line))[2]
+            msg = c_format(fmt, args)
+        else:
+            msg = '<unknown format %08x> %s' % (fmt_id, ' '.join(str(v) for _, v in args))
+
+        secs = time_ms // 1000
+        text = '[%02d:%02d:%02d.%03d]%s[%s:%d]: %s' % (
+            (secs % 86400) // 3600, (secs // 60) % 60, secs % 60, time_ms % 1000,
+            LEVEL_TAGS[level], file_name, line, msg)
+        if self.color:
+            text = LEVEL_COLORS[level] + text + '\033[0m'
+        return text + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode TT_LOG_BINARY serial output')
+    parser.add_argument('input', nargs='?', default='-', help="capture file, '-' for stdin")
+    parser.add_argument('--port', help='read from this serial port instead (pyserial)')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--src', action='append', help='source roots to scan (default: src)')
+    parser.add_argument('--no-color', action='store_true')
+    opts = parser.parse_args()
+
+    project = Path(__file__).resolve().parent.parent
+    roots = opts.src or [project / 'src']
+    formats, names = build_dictionary(roots)
+    print('Loaded %d format strings from %d files' % (sum(len(v) for v in formats.values()), len(names)),
+          file=sys.stderr)
+    decoder = Decoder(formats, names, not opts.no_color)
+
+    if opts.port:
+        import serial
+        stream = serial.Serial(opts.port, opts.baud, timeout=0.1)
+        read = lambda: stream.read(4096)
+    elif opts.input == '-':
+        read = lambda: sys.stdin.buffer.read1(4096)
+    else:
+        stream = open(opts.input, 'rb')
+        read = lambda: stream.read(4096)
+
+    try:
+        while True:
+            chunk = read()
+            if not chunk and not opts.port:
+                break
+            sys.stdout.write(decoder.feed(chunk))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+Simulator Scenario Check
+Runs every tools/sim/*.sim script through the host simulator (env:native) on the virtual clock; the
+scripts' `golden` and `expect` lines check the panel against tools/sim/golden/*.pbm and the refresh
+budgets (see src/Native/TTSimulator.cpp). Each scenario boots on a fresh LittleFS seeded from data/,
+so no run sees another's preferences or frame record.
+
+Usage:
+    pio run -e native
+    python tools/sim_check.py                   # all scenarios; exit status 1 on any failure
+    python tools/sim_check.py tools/sim/clock.sim
+    python tools/sim_check.py --update          # re-record the goldens, then review and commit them
+
+A mismatching frame is kept next to its golden as NAME.actual.pbm.
+"""
+
+import argparse
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+ROOT = Path(__file__).parent.parent
+PROGRAM = ROOT / ".pio" / "build" / "native" / "program"
+SCENARIOS = ROOT / "tools" / "sim"
+GOLDENS = SCENARIOS / "golden"
+TIMEOUT_S = 300
+
+
+def run_scenario(program, scenario, update):
+    """Runs one script; returns (passed, check lines)"""
+    with tempfile.TemporaryDirectory() as tmp:
+        cmd = [str(program), "--virtual", "--script", str(scenario), "--goldens", str(GOLDENS),
+               "--fs", str(Path(tmp) / "littlefs"), "--seed", str(ROOT / "data")]
+        if update:
+            cmd.append("--update-goldens")
+        result = subprocess.run(cmd, cwd=ROOT, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True, timeout=TIMEOUT_S)
+    lines = result.stdout.splitlines()
+    checks = [l for l in lines if l.startswith(("GOLDEN", "EXPECT"))]
+    if result.returncode != 0 and not any("FAIL" in l or "missing" in l for l in checks):
+        checks += lines[-20:]       # Crashed or bailed out before a check: show how it ended
+    return result.returncode == 0, checks
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the simulator scenarios against their goldens")
+    parser.add_argument("scenarios", nargs="*", help="scripts to run (default: tools/sim/*.sim)")
+    parser.add_argument("--program", default=str(PROGRAM), help="simulator binary")
+    parser.add_argument("--update", action="store_true", help="re-record the golden frames")
+    args = parser.parse_args()
+
+    program = Path(args.program)
+    if not program.exists():
+        print(f"Error: {program} not found, build it with `pio run -e native`")
+        sys.exit(2)
+    scenarios = [Path(s) for s in args.scenarios] or sorted(SCENARIOS.glob("*.sim"))
+    GOLDENS.mkdir(parents=True, exist_ok=True)
+
+    failed = []
+    for scenario in scenarios:
+        passed, checks = run_scenario(program, scenario.resolve(), args.update)
+        print(f"{'ok  ' if passed else 'FAIL'} {scenario.name}")
+        for line in checks:
+            if not passed or args.update:
+                print(f"     {line}")
+        if not passed:
+            failed.append(scenario.name)
+
+    if failed:
+        print(f"{len(failed)} of {len(scenarios)} scenario(s) failed: {', '.join(failed)}")
+        sys.exit(1)
+    print(f"{len(scenarios)} scenario(s) {'recorded' if args.update else 'passed'}")
+
+
+if __name__ == "__main__":
+    main()